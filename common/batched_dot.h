@@ -0,0 +1,134 @@
+#ifndef BATCHED_DOT_H
+#define BATCHED_DOT_H
+
+// пакетное скалярное произведение множества коротких пар векторов
+// вместо отдельного #pragma omp parallel на каждую пару весь пакет
+// обрабатывается одной параллельной областью:
+// - DOT_BATCH_ACROSS: пары распределяются между потоками, каждая пара
+//   считается целиком одним потоком векторизованным ядром (короткие пары)
+// - DOT_BATCH_WITHIN: пары идут по очереди, каждая делится между всеми потоками
+//   (мало длинных пар, которых не хватает на все потоки)
+// - DOT_BATCH_AUTO: выбор по числу пар и их средней длине
+//
+// раскладка пакета:
+// - strided: пара i - x[i*stride .. i*stride+length), то же для y
+// - csr: пара i - x[offsets[i] .. offsets[i+1]), длины могут различаться
+
+#include "mixed_dot.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define DOT_BATCH_SPLIT_MIN 8192  // минимальная длина пары, которую имеет смысл делить между потоками
+
+typedef enum {
+    DOT_BATCH_AUTO = 0,
+    DOT_BATCH_ACROSS = 1,
+    DOT_BATCH_WITHIN = 2
+} dot_batch_strategy_t;
+
+typedef struct {
+    const double *x;
+    const double *y;
+    long count;           // число пар
+    const long *offsets;  // csr: count + 1 смещений; NULL - раскладка strided
+    long length;          // strided: длина каждой пары
+    long stride;          // strided: расстояние между началами соседних пар
+} dot_batch_t;
+
+static inline dot_batch_t dot_batch_strided(const double *x, const double *y, long count,
+                                            long length, long stride) {
+    dot_batch_t b = {x, y, count, NULL, length, stride};
+    return b;
+}
+
+static inline dot_batch_t dot_batch_csr(const double *x, const double *y, long count,
+                                        const long *offsets) {
+    dot_batch_t b = {x, y, count, offsets, 0, 0};
+    return b;
+}
+
+static inline const char *dot_batch_strategy_name(dot_batch_strategy_t s) {
+    switch (s) {
+        case DOT_BATCH_ACROSS: return "по парам";
+        case DOT_BATCH_WITHIN: return "внутри пары";
+        default:               return "авто";
+    }
+}
+
+// начало и длина пары i
+static inline void dot_batch_pair(const dot_batch_t *b, long i, long *begin, long *len) {
+    if (b->offsets != NULL) {
+        *begin = b->offsets[i];
+        *len = b->offsets[i + 1] - b->offsets[i];
+    } else {
+        *begin = i * b->stride;
+        *len = b->length;
+    }
+}
+
+// выбор стратегии: делить пары между потоками выгодно, только когда пар
+// не хватает на все потоки, а сами пары достаточно длинные
+static inline dot_batch_strategy_t dot_batch_choose(const dot_batch_t *b, int nthreads) {
+    if (b->count <= 0) return DOT_BATCH_ACROSS;
+    long total = b->offsets != NULL ? b->offsets[b->count] - b->offsets[0] : b->count * b->length;
+    long avg = total / b->count;
+    if (b->count < 2L * nthreads && avg >= DOT_BATCH_SPLIT_MIN) return DOT_BATCH_WITHIN;
+    return DOT_BATCH_ACROSS;
+}
+
+// out[i] = <x_i, y_i> для всех пар пакета; возвращает использованную стратегию
+static inline dot_batch_strategy_t dot_batch(const dot_batch_t *b, double *out,
+                                             dot_batch_strategy_t strategy) {
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+#else
+    int nthreads = 1;
+#endif
+    if (strategy == DOT_BATCH_AUTO) strategy = dot_batch_choose(b, nthreads);
+    dot_kernel_name();  // выбор ядра до входа в параллельную область
+
+    if (strategy == DOT_BATCH_ACROSS) {
+        // длины csr-пар различаются - динамическое распределение выравнивает нагрузку
+        if (b->offsets != NULL) {
+            #pragma omp parallel for schedule(dynamic, 64)
+            for (long i = 0; i < b->count; i++) {
+                long begin, len;
+                dot_batch_pair(b, i, &begin, &len);
+                out[i] = dot_typed(b->x + begin, b->y + begin, len, DOT_DOUBLE);
+            }
+        } else {
+            #pragma omp parallel for schedule(static)
+            for (long i = 0; i < b->count; i++) {
+                out[i] = dot_typed(b->x + i * b->stride, b->y + i * b->stride, b->length, DOT_DOUBLE);
+            }
+        }
+        return strategy;
+    }
+
+    // внутри пары: одна параллельная область на весь пакет, каждый поток
+    // берет свой непрерывный кусок пары и считает его векторизованным ядром
+    #pragma omp parallel
+    {
+#ifdef _OPENMP
+        long nt = omp_get_num_threads(), tid = omp_get_thread_num();
+#else
+        long nt = 1, tid = 0;
+#endif
+        for (long i = 0; i < b->count; i++) {
+            long begin, len;
+            dot_batch_pair(b, i, &begin, &len);
+            long lo = begin + len * tid / nt;
+            long hi = begin + len * (tid + 1) / nt;
+            double part = dot_typed(b->x + lo, b->y + lo, hi - lo, DOT_DOUBLE);
+
+            #pragma omp single
+            out[i] = 0.0;  // неявный барьер: обнуление видно всем потокам
+            #pragma omp atomic
+            out[i] += part;
+        }
+    }
+    return strategy;
+}
+
+#endif // BATCHED_DOT_H
@@ -0,0 +1,311 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// общий каркас для замеров времени в заданиях openmp и mpi
+//
+// - прогрев (warmup) и повторения (reps) задаются переменными окружения
+//   BENCH_WARMUP и BENCH_REPS, значения по умолчанию выбирает программа
+// - по выборке считаются min, медиана, p95, среднее, стандартное отклонение
+//   и 95% доверительный интервал среднего; выбросы отбрасываются по правилу
+//   тьюки (за пределами [q1 - 1.5 iqr, q3 + 1.5 iqr])
+// - результаты дописываются строками в csv или json lines (по расширению файла)
+//   вместе с именем узла, числом потоков/процессов и версией компилятора;
+//   файл задается переменной BENCH_OUTPUT или путем по умолчанию программы
+//
+// при подключении после <mpi.h> доступен bench_run_mpi: перед каждым повторением
+// процессы синхронизируются барьером, время повторения - максимум по процессам
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define BENCH_MAX_REPS 1000
+#define BENCH_NAME_LEN 64
+
+typedef struct {
+    int warmup;  // прогревочные запуски (не учитываются)
+    int reps;    // измеряемые повторения
+} bench_config_t;
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    int warmup;
+    int reps;
+    int kept;        // повторений после отбрасывания выбросов
+    int outliers;    // отброшено выбросов
+    double min;      // минимальное время (по всем повторениям)
+    double median;   // медиана (по всем повторениям)
+    double p95;      // 95-й перцентиль (по всем повторениям)
+    double mean;     // среднее без выбросов
+    double stddev;   // стандартное отклонение без выбросов
+    double ci_low;   // нижняя граница 95% доверительного интервала среднего
+    double ci_high;  // верхняя граница
+} bench_result_t;
+
+typedef void (*bench_fn_t)(void *ctx);
+
+// настройки из окружения с запасными значениями программы
+static inline bench_config_t bench_config_from_env(int default_warmup, int default_reps) {
+    bench_config_t cfg = {default_warmup, default_reps};
+    const char *w = getenv("BENCH_WARMUP");
+    const char *r = getenv("BENCH_REPS");
+    if (w != NULL && *w != '\0') cfg.warmup = atoi(w);
+    if (r != NULL && *r != '\0') cfg.reps = atoi(r);
+    if (cfg.warmup < 0) cfg.warmup = 0;
+    if (cfg.reps < 1) cfg.reps = 1;
+    if (cfg.reps > BENCH_MAX_REPS) cfg.reps = BENCH_MAX_REPS;
+    return cfg;
+}
+
+static inline double bench_now(void) {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+static inline int bench_compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// перцентиль отсортированной выборки с линейной интерполяцией
+static inline double bench_percentile(const double *sorted, int n, double p) {
+    if (n == 1) return sorted[0];
+    double pos = p * (n - 1);
+    int lo = (int)pos;
+    if (lo >= n - 1) return sorted[n - 1];
+    double frac = pos - lo;
+    return sorted[lo] + frac * (sorted[lo + 1] - sorted[lo]);
+}
+
+// квантиль t-распределения стьюдента для двустороннего 95% интервала
+static inline double bench_t95(int df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return 0.0;
+    if (df <= 30) return table[df - 1];
+    return 1.96;
+}
+
+// статистика по выборке времен (массив сортируется на месте)
+static inline void bench_summarize(const char *name, double *samples, int n,
+                                   bench_config_t cfg, bench_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->warmup = cfg.warmup;
+    r->reps = n;
+    if (n <= 0) return;
+
+    qsort(samples, n, sizeof(double), bench_compare_double);
+    r->min = samples[0];
+    r->median = bench_percentile(samples, n, 0.5);
+    r->p95 = bench_percentile(samples, n, 0.95);
+
+    // отбрасывание выбросов по правилу тьюки
+    double q1 = bench_percentile(samples, n, 0.25);
+    double q3 = bench_percentile(samples, n, 0.75);
+    double iqr = q3 - q1;
+    double lo = q1 - 1.5 * iqr, hi = q3 + 1.5 * iqr;
+
+    double sum = 0.0;
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        if (samples[i] >= lo && samples[i] <= hi) {
+            sum += samples[i];
+            kept++;
+        }
+    }
+    double mean = sum / kept;
+    double ss = 0.0;
+    for (int i = 0; i < n; i++) {
+        if (samples[i] >= lo && samples[i] <= hi) {
+            ss += (samples[i] - mean) * (samples[i] - mean);
+        }
+    }
+
+    r->kept = kept;
+    r->outliers = n - kept;
+    r->mean = mean;
+    r->stddev = kept > 1 ? sqrt(ss / (kept - 1)) : 0.0;
+    double half = kept > 1 ? bench_t95(kept - 1) * r->stddev / sqrt((double)kept) : 0.0;
+    r->ci_low = mean - half;
+    r->ci_high = mean + half;
+}
+
+// замер функции: cfg.warmup прогревочных и cfg.reps измеряемых запусков
+static inline void bench_run(const char *name, bench_fn_t fn, void *ctx,
+                             bench_config_t cfg, bench_result_t *r) {
+    double samples[BENCH_MAX_REPS];
+    for (int i = 0; i < cfg.warmup; i++) {
+        fn(ctx);
+    }
+    for (int i = 0; i < cfg.reps; i++) {
+        double start = bench_now();
+        fn(ctx);
+        samples[i] = bench_now() - start;
+    }
+    bench_summarize(name, samples, cfg.reps, cfg, r);
+}
+
+#ifdef MPI_VERSION
+// замер коллективного кода: барьер перед каждым повторением,
+// время повторения - максимум по всем процессам; результат одинаков на всех процессах
+static inline void bench_run_mpi(const char *name, bench_fn_t fn, void *ctx,
+                                 bench_config_t cfg, MPI_Comm comm, bench_result_t *r) {
+    double samples[BENCH_MAX_REPS];
+    for (int i = 0; i < cfg.warmup; i++) {
+        MPI_Barrier(comm);
+        fn(ctx);
+    }
+    for (int i = 0; i < cfg.reps; i++) {
+        MPI_Barrier(comm);
+        double start = MPI_Wtime();
+        fn(ctx);
+        double local = MPI_Wtime() - start;
+        MPI_Allreduce(&local, &samples[i], 1, MPI_DOUBLE, MPI_MAX, comm);
+    }
+    bench_summarize(name, samples, cfg.reps, cfg, r);
+}
+#endif // MPI_VERSION
+
+// краткая строка для человека
+static inline void bench_print(const bench_result_t *r) {
+    printf("  %-24s медиана = %.6f с, min = %.6f с, p95 = %.6f с, "
+           "среднее = %.6f ± %.6f с (95%%), выбросов: %d/%d\n",
+           r->name, r->median, r->min, r->p95, r->mean,
+           (r->ci_high - r->ci_low) / 2.0, r->outliers, r->reps);
+}
+
+static inline const char *bench_compiler(void) {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+static inline void bench_json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+// является ли строка числом (чтобы записать его в json без кавычек)
+static inline int bench_is_number(const char *s) {
+    if (*s == '\0') return 0;
+    char *end;
+    strtod(s, &end);
+    return *end == '\0';
+}
+
+// запись строки результата
+// params - дополнительные параметры эксперимента в виде "ключ=значение;ключ=значение",
+// в csv они становятся отдельными столбцами (перед стандартными), в json - полями;
+// все строки одного csv-файла должны иметь один набор ключей в одном порядке
+static inline void bench_write(const char *default_path, const bench_result_t *r,
+                               const char *params, int threads, int ranks) {
+    const char *path = getenv("BENCH_OUTPUT");
+    if (path == NULL || *path == '\0') path = default_path;
+    if (path == NULL) return;
+
+    FILE *fp = fopen(path, "a+");  // чтение - для сверки заголовка csv
+    if (fp == NULL) return;
+
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+
+    // разбираем параметры на пары ключ/значение
+    char buf[1024];
+    char *keys[32], *values[32];
+    int nparams = 0;
+    snprintf(buf, sizeof(buf), "%s", params ? params : "");
+    for (char *tok = strtok(buf, ";"); tok != NULL && nparams < 32; tok = strtok(NULL, ";")) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL) continue;
+        *eq = '\0';
+        keys[nparams] = tok;
+        values[nparams] = eq + 1;
+        nparams++;
+    }
+
+    size_t len = strlen(path);
+    int json = (len >= 5 && strcmp(path + len - 5, ".json") == 0) ||
+               (len >= 6 && strcmp(path + len - 6, ".jsonl") == 0);
+
+    if (json) {
+        fprintf(fp, "{\"benchmark\":");
+        bench_json_string(fp, r->name);
+        for (int i = 0; i < nparams; i++) {
+            fprintf(fp, ",");
+            bench_json_string(fp, keys[i]);
+            fprintf(fp, ":");
+            if (bench_is_number(values[i])) fprintf(fp, "%s", values[i]);
+            else bench_json_string(fp, values[i]);
+        }
+        fprintf(fp, ",\"host\":");
+        bench_json_string(fp, host);
+        fprintf(fp, ",\"compiler\":");
+        bench_json_string(fp, bench_compiler());
+        fprintf(fp, ",\"threads\":%d,\"ranks\":%d,\"warmup\":%d,\"reps\":%d,\"kept\":%d,"
+                    "\"min\":%.9f,\"median\":%.9f,\"p95\":%.9f,\"mean\":%.9f,\"stddev\":%.9f,"
+                    "\"ci95_low\":%.9f,\"ci95_high\":%.9f}\n",
+                threads, ranks, r->warmup, r->reps, r->kept, r->min, r->median, r->p95,
+                r->mean, r->stddev, r->ci_low, r->ci_high);
+    } else {
+        // заголовок определяется набором ключей params: пустой файл получает его,
+        // а строка с другим набором ключей не дописывается (столбцы бы съехали)
+        char header[2048];
+        int hlen = snprintf(header, sizeof(header), "benchmark");
+        for (int i = 0; i < nparams && hlen < (int)sizeof(header); i++)
+            hlen += snprintf(header + hlen, sizeof(header) - hlen, ",%s", keys[i]);
+        if (hlen < (int)sizeof(header))
+            snprintf(header + hlen, sizeof(header) - hlen, ",host,compiler,threads,ranks,warmup,reps,kept,"
+                     "min,median,p95,mean,stddev,ci95_low,ci95_high");
+        char existing[2048] = "";
+        rewind(fp);
+        if (fgets(existing, sizeof(existing), fp) != NULL) existing[strcspn(existing, "\n")] = '\0';
+        if (existing[0] == '\0') {
+            fprintf(fp, "%s\n", header);
+        } else if (strcmp(existing, header) != 0) {
+            fprintf(stderr, "bench_write: столбцы %s не совпадают с заголовком %s, строка не записана\n",
+                    path, existing);
+            fclose(fp);
+            return;
+        }
+        fprintf(fp, "%s", r->name);
+        for (int i = 0; i < nparams; i++) fprintf(fp, ",%s", values[i]);
+        fprintf(fp, ",%s,\"%s\",%d,%d,%d,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f\n",
+                host, bench_compiler(), threads, ranks, r->warmup, r->reps, r->kept,
+                r->min, r->median, r->p95, r->mean, r->stddev, r->ci_low, r->ci_high);
+    }
+    fclose(fp);
+}
+
+// число потоков openmp для строки результата
+static inline int bench_threads(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,165 @@
+#ifndef FUSED_STATS_H
+#define FUSED_STATS_H
+
+// однопроходная статистика массива double:
+// минимум, максимум, их индексы, количество, среднее и дисперсия
+// массив обрабатывается блоками: внутри блока считаются суммы отклонений
+// от первого элемента блока (без деления на каждом шаге), затем блоки,
+// потоки и процессы объединяются формулой чана (parallel welford)
+//
+// при подключении после <omp.h> объявляется редукция openmp merge_stats,
+// при подключении после <mpi.h> - тип и операция mpi для той же структуры
+
+#include <stddef.h>
+
+#define STATS_BLOCK 4096  // размер блока: помещается в l1, погрешность сдвинутых сумм мала
+
+typedef struct {
+    double min;      // минимальное значение
+    double max;      // максимальное значение
+    double mean;     // среднее
+    double m2;       // сумма квадратов отклонений от среднего
+    long argmin;     // глобальный индекс минимума (первое вхождение)
+    long argmax;     // глобальный индекс максимума (первое вхождение)
+    long count;      // количество элементов
+} array_stats_t;
+
+// пустая статистика - нейтральный элемент для объединения
+static inline array_stats_t stats_empty(void) {
+    array_stats_t s;
+    s.min = 1.0 / 0.0;
+    s.max = -1.0 / 0.0;
+    s.mean = 0.0;
+    s.m2 = 0.0;
+    s.argmin = -1;
+    s.argmax = -1;
+    s.count = 0;
+    return s;
+}
+
+// объединение двух статистик (формула чана для среднего и m2)
+// при равных экстремумах берется меньший индекс, поэтому порядок не важен
+static inline array_stats_t stats_merge(array_stats_t a, array_stats_t b) {
+    if (b.count == 0) return a;
+    if (a.count == 0) return b;
+
+    array_stats_t r;
+    if (b.min < a.min || (b.min == a.min && b.argmin < a.argmin)) {
+        r.min = b.min; r.argmin = b.argmin;
+    } else {
+        r.min = a.min; r.argmin = a.argmin;
+    }
+    if (b.max > a.max || (b.max == a.max && b.argmax < a.argmax)) {
+        r.max = b.max; r.argmax = b.argmax;
+    } else {
+        r.max = a.max; r.argmax = a.argmax;
+    }
+
+    long n = a.count + b.count;
+    double delta = b.mean - a.mean;
+    r.count = n;
+    r.mean = a.mean + delta * ((double)b.count / n);
+    r.m2 = a.m2 + b.m2 + delta * delta * ((double)a.count * b.count / n);
+    return r;
+}
+
+// статистика одного блока за один проход
+// offset - глобальный индекс первого элемента блока (для argmin/argmax)
+static inline array_stats_t stats_block(const double *arr, long n, long offset) {
+    array_stats_t s = stats_empty();
+    if (n <= 0) return s;
+
+    double shift = arr[0];  // сдвиг убирает катастрофическое сокращение в s2 - s1*s1/n
+    double mn = arr[0], mx = arr[0];
+    long imn = 0, imx = 0;
+    double s1 = 0.0, s2 = 0.0;
+
+    for (long i = 0; i < n; i++) {
+        double x = arr[i];
+        double d = x - shift;
+        s1 += d;
+        s2 += d * d;
+        if (x < mn) { mn = x; imn = i; }
+        if (x > mx) { mx = x; imx = i; }
+    }
+
+    s.min = mn;
+    s.max = mx;
+    s.argmin = offset + imn;
+    s.argmax = offset + imx;
+    s.count = n;
+    s.mean = shift + s1 / n;
+    s.m2 = s2 - s1 * s1 / n;
+    if (s.m2 < 0.0) s.m2 = 0.0;  // защита от отрицательного значения из-за округления
+    return s;
+}
+
+// последовательная статистика всего массива (блоками по STATS_BLOCK)
+static inline array_stats_t stats_compute(const double *arr, long n, long offset) {
+    array_stats_t s = stats_empty();
+    for (long lo = 0; lo < n; lo += STATS_BLOCK) {
+        long len = (n - lo < STATS_BLOCK) ? n - lo : STATS_BLOCK;
+        s = stats_merge(s, stats_block(arr + lo, len, offset + lo));
+    }
+    return s;
+}
+
+// дисперсия: генеральная (ddof = 0) или выборочная (ddof = 1)
+static inline double stats_variance(array_stats_t s, int ddof) {
+    if (s.count - ddof <= 0) return 0.0;
+    return s.m2 / (double)(s.count - ddof);
+}
+
+#ifdef _OPENMP
+// пользовательская редукция openmp: reduction(merge_stats:var)
+#pragma omp declare reduction(merge_stats : array_stats_t : omp_out = stats_merge(omp_out, omp_in)) \
+    initializer(omp_priv = stats_empty())
+
+// параллельная статистика: блоки распределяются статически, потоки объединяются редукцией
+static inline array_stats_t stats_compute_parallel(const double *arr, long n, long offset) {
+    array_stats_t s = stats_empty();
+    long nblocks = (n + STATS_BLOCK - 1) / STATS_BLOCK;
+
+    #pragma omp parallel for schedule(static) reduction(merge_stats:s)
+    for (long b = 0; b < nblocks; b++) {
+        long lo = b * STATS_BLOCK;
+        long len = (n - lo < STATS_BLOCK) ? n - lo : STATS_BLOCK;
+        s = stats_merge(s, stats_block(arr + lo, len, offset + lo));
+    }
+    return s;
+}
+#endif // _OPENMP
+
+#ifdef MPI_VERSION
+// функция пользовательской операции mpi: inoutvec[i] = merge(invec[i], inoutvec[i])
+static void stats_mpi_merge(void *invec, void *inoutvec, int *len, MPI_Datatype *datatype) {
+    (void)datatype;
+    array_stats_t *in = (array_stats_t *)invec;
+    array_stats_t *inout = (array_stats_t *)inoutvec;
+    for (int i = 0; i < *len; i++) {
+        inout[i] = stats_merge(in[i], inout[i]);
+    }
+}
+
+// создание mpi-типа для array_stats_t (4 double + 3 long) и операции объединения
+static inline void stats_mpi_create(MPI_Datatype *type, MPI_Op *op) {
+    int blocklens[2] = {4, 3};
+    MPI_Aint displs[2] = {offsetof(array_stats_t, min), offsetof(array_stats_t, argmin)};
+    MPI_Datatype types[2] = {MPI_DOUBLE, MPI_LONG};
+    MPI_Datatype tmp;
+
+    MPI_Type_create_struct(2, blocklens, displs, types, &tmp);
+    MPI_Type_create_resized(tmp, 0, sizeof(array_stats_t), type);  // учитываем выравнивание структуры
+    MPI_Type_commit(type);
+    MPI_Type_free(&tmp);
+
+    MPI_Op_create(stats_mpi_merge, 1, op);  // операция коммутативна
+}
+
+static inline void stats_mpi_free(MPI_Datatype *type, MPI_Op *op) {
+    MPI_Op_free(op);
+    MPI_Type_free(type);
+}
+#endif // MPI_VERSION
+
+#endif // FUSED_STATS_H
@@ -0,0 +1,293 @@
+#ifndef GAUSS_KRONROD_H
+#define GAUSS_KRONROD_H
+
+// адаптивное интегрирование по правилу гаусса-кронрода g7-k15
+//
+// на каждом отрезке 15 точек кронрода дают интеграл, а вложенные 7 точек гаусса -
+// оценку погрешности (формула quadpack qk15). отрезки лежат в общей очереди
+// с приоритетом (max-куча по оценке погрешности); задачи openmp берут из нее
+// отрезок с наибольшей погрешностью, делят пополам и возвращают половины,
+// пока суммарная погрешность не станет меньше max(abs_tol, rel_tol * |I|).
+// задачи берут работу по мере освобождения, поэтому на функциях с острыми пиками,
+// где почти все деления приходятся на малую область, потоки остаются загружены
+//
+// подынтегральная функция вычисляется пачками точек: fn(x, fx, n, ctx),
+// что позволяет векторизовать ее или вычислять интерпретатором
+
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define GK_POINTS 15
+#define GK_MAX_THREADS 256
+
+typedef void (*gk_batch_fn_t)(const double *x, double *fx, int n, void *ctx);
+
+typedef struct {
+    double a, b;
+    double result;  // интеграл по отрезку (k15)
+    double error;   // оценка погрешности
+} gk_interval_t;
+
+typedef struct {
+    double result;       // приближенное значение интеграла
+    double error;        // оценка абсолютной погрешности
+    long evaluations;    // число вычислений подынтегральной функции
+    long intervals;      // число отрезков в итоговом разбиении
+    int converged;       // 1 - точность достигнута, 0 - исчерпан лимит вычислений
+    int out_of_memory;   // 1 - очередь отрезков не удалось увеличить: итог по уже
+                         // полученному разбиению, converged = 0
+    long refined_min;    // меньше всего делений, выполненных одним потоком
+    long refined_max;    // больше всего делений, выполненных одним потоком
+} gk_result_t;
+
+// узлы и веса кронрода (xgk[1], xgk[3], xgk[5], xgk[7] - узлы гаусса)
+static const double gk_xgk[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+static const double gk_wgk[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+static const double gk_wg[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+// правило g7-k15 на одном отрезке (одно обращение к fn на 15 точек)
+static inline gk_interval_t gk15(gk_batch_fn_t fn, void *ctx, double a, double b) {
+    double centr = 0.5 * (a + b);
+    double hlgth = 0.5 * (b - a);
+    double x[GK_POINTS], fx[GK_POINTS];
+
+    // x[0] - центр, x[1 + 2j] и x[2 + 2j] - пара симметричных узлов xgk[j]
+    x[0] = centr;
+    for (int j = 0; j < 7; j++) {
+        x[1 + 2 * j] = centr - hlgth * gk_xgk[j];
+        x[2 + 2 * j] = centr + hlgth * gk_xgk[j];
+    }
+    fn(x, fx, GK_POINTS, ctx);
+
+    double fc = fx[0];
+    double resg = fc * gk_wg[3];
+    double resk = fc * gk_wgk[7];
+    double resabs = fabs(resk);
+    for (int j = 0; j < 7; j++) {
+        double f1 = fx[1 + 2 * j], f2 = fx[2 + 2 * j];
+        resk += gk_wgk[j] * (f1 + f2);
+        resabs += gk_wgk[j] * (fabs(f1) + fabs(f2));
+        if (j & 1) resg += gk_wg[j / 2] * (f1 + f2);  // нечетные узлы кронрода - узлы гаусса
+    }
+    double reskh = 0.5 * resk;
+    double resasc = gk_wgk[7] * fabs(fc - reskh);
+    for (int j = 0; j < 7; j++) {
+        resasc += gk_wgk[j] * (fabs(fx[1 + 2 * j] - reskh) + fabs(fx[2 + 2 * j] - reskh));
+    }
+
+    gk_interval_t r;
+    r.a = a;
+    r.b = b;
+    r.result = resk * hlgth;
+    resabs *= fabs(hlgth);
+    resasc *= fabs(hlgth);
+    r.error = fabs((resk - resg) * hlgth);
+    if (resasc != 0.0 && r.error != 0.0) {
+        double scale = pow(200.0 * r.error / resasc, 1.5);
+        r.error = resasc * (scale < 1.0 ? scale : 1.0);
+    }
+    if (resabs > DBL_MIN / (50.0 * DBL_EPSILON) && r.error < 50.0 * DBL_EPSILON * resabs) {
+        r.error = 50.0 * DBL_EPSILON * resabs;  // не точнее машинной точности
+    }
+    return r;
+}
+
+// очередь с приоритетом: max-куча отрезков по оценке погрешности
+typedef struct {
+    gk_interval_t *items;
+    long size;
+    long capacity;
+} gk_heap_t;
+
+// место под need отрезков; 0 - не хватает памяти (куча не меняется)
+static inline int gk_heap_reserve(gk_heap_t *h, long need) {
+    if (need <= h->capacity) return 1;
+    long capacity = h->capacity ? 2 * h->capacity : 256;
+    while (capacity < need) capacity *= 2;
+    gk_interval_t *items = (gk_interval_t *)realloc(h->items, capacity * sizeof(gk_interval_t));
+    if (items == NULL) return 0;
+    h->items = items;
+    h->capacity = capacity;
+    return 1;
+}
+
+// место должно быть зарезервировано (gk_heap_reserve)
+static inline void gk_heap_push(gk_heap_t *h, gk_interval_t it) {
+    long i = h->size++;
+    while (i > 0) {
+        long parent = (i - 1) / 2;
+        if (h->items[parent].error >= it.error) break;
+        h->items[i] = h->items[parent];
+        i = parent;
+    }
+    h->items[i] = it;
+}
+
+static inline gk_interval_t gk_heap_pop(gk_heap_t *h) {
+    gk_interval_t top = h->items[0];
+    gk_interval_t last = h->items[--h->size];
+    long i = 0;
+    for (;;) {
+        long child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && h->items[child + 1].error > h->items[child].error) child++;
+        if (h->items[child].error <= last.error) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->size > 0) h->items[i] = last;
+    return top;
+}
+
+// адаптивный интеграл fn по [a, b] с точностью max(abs_tol, rel_tol * |I|)
+// max_evals ограничивает число вычислений функции
+static inline gk_result_t gk_integrate(gk_batch_fn_t fn, void *ctx, double a, double b,
+                                       double abs_tol, double rel_tol, long max_evals) {
+    gk_heap_t heap = {NULL, 0, 0};
+    gk_interval_t first = gk15(fn, ctx, a, b);
+    if (!gk_heap_reserve(&heap, 1)) {
+        // очередь не выделена - итог по одному отрезку
+        gk_result_t r = {first.result, first.error, GK_POINTS, 1, 0, 1, 0, 0};
+        return r;
+    }
+    gk_heap_push(&heap, first);
+    int out_of_memory = 0;
+
+    double total_result = first.result;
+    double total_error = first.error;
+    long evaluations = GK_POINTS;
+    long in_flight = 0;  // отрезков, которые сейчас делятся
+    int done = 0;
+    long refined[GK_MAX_THREADS] = {0};
+    int nthreads = 1;
+
+#ifdef _OPENMP
+    omp_lock_t lock;
+    omp_init_lock(&lock);
+#define GK_LOCK() omp_set_lock(&lock)
+#define GK_UNLOCK() omp_unset_lock(&lock)
+#else
+#define GK_LOCK()
+#define GK_UNLOCK()
+#endif
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+#ifdef _OPENMP
+            nthreads = omp_get_num_threads();
+            if (nthreads > GK_MAX_THREADS) nthreads = GK_MAX_THREADS;
+#endif
+            // по задаче-обработчику на поток: каждая берет худший отрезок из общей очереди
+            for (int w = 0; w < nthreads; w++) {
+                #pragma omp task shared(heap, total_result, total_error, evaluations, in_flight, done, refined, \
+                                        out_of_memory)
+                {
+                    for (;;) {
+                        gk_interval_t parent;
+                        int have = 0;
+                        GK_LOCK();
+                        if (!done) {
+                            double tol = fmax(abs_tol, rel_tol * fabs(total_result));
+                            if (total_error <= tol || evaluations >= max_evals) {
+                                done = 1;
+                            } else if (heap.size > 0 && !gk_heap_reserve(&heap, heap.size + in_flight + 2)) {
+                                // каждый делящийся отрезок вернет на один больше, чем взял:
+                                // место под все половины резервируется до деления
+                                out_of_memory = 1;
+                                done = 1;
+                            } else if (heap.size > 0) {
+                                parent = gk_heap_pop(&heap);
+                                in_flight++;
+                                have = 1;
+                            } else if (in_flight == 0) {
+                                done = 1;  // делить больше нечего
+                            }
+                        }
+                        int finished = done;
+                        GK_UNLOCK();
+                        if (finished) break;
+                        if (!have) {  // очередь временно пуста - другие задачи вернут половины
+#ifdef _OPENMP
+                            #pragma omp taskyield
+#endif
+                            continue;
+                        }
+
+                        double mid = 0.5 * (parent.a + parent.b);
+                        gk_interval_t left = gk15(fn, ctx, parent.a, mid);
+                        gk_interval_t right = gk15(fn, ctx, mid, parent.b);
+
+                        GK_LOCK();
+                        gk_heap_push(&heap, left);
+                        gk_heap_push(&heap, right);
+                        total_result += left.result + right.result - parent.result;
+                        total_error += left.error + right.error - parent.error;
+                        evaluations += 2 * GK_POINTS;
+                        in_flight--;
+#ifdef _OPENMP
+                        int tid = omp_get_thread_num();
+#else
+                        int tid = 0;
+#endif
+                        if (tid < GK_MAX_THREADS) refined[tid]++;
+                        GK_UNLOCK();
+                    }
+                }
+            }
+        }
+    }
+
+#undef GK_LOCK
+#undef GK_UNLOCK
+#ifdef _OPENMP
+    omp_destroy_lock(&lock);
+#endif
+
+    // итог пересчитывается по отрезкам, чтобы не накапливать ошибку инкрементов
+    gk_result_t r;
+    r.result = 0.0;
+    r.error = 0.0;
+    for (long i = 0; i < heap.size; i++) {
+        r.result += heap.items[i].result;
+        r.error += heap.items[i].error;
+    }
+    r.evaluations = evaluations;
+    r.intervals = heap.size;
+    r.out_of_memory = out_of_memory;
+    r.converged = !out_of_memory && r.error <= fmax(abs_tol, rel_tol * fabs(r.result));
+    r.refined_min = refined[0];
+    r.refined_max = refined[0];
+    for (int t = 1; t < nthreads; t++) {
+        if (refined[t] < r.refined_min) r.refined_min = refined[t];
+        if (refined[t] > r.refined_max) r.refined_max = refined[t];
+    }
+    free(heap.items);
+    return r;
+}
+
+// пояснение к итогу для печати: "", " - точность не достигнута" или нехватка памяти
+static inline const char *gk_status_note(const gk_result_t *r) {
+    if (r->out_of_memory) return " - не хватило памяти под отрезки";
+    return r->converged ? "" : " - точность не достигнута";
+}
+
+#endif // GAUSS_KRONROD_H
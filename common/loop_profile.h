@@ -0,0 +1,224 @@
+#ifndef LOOP_PROFILE_H
+#define LOOP_PROFILE_H
+
+// профиль дисбаланса нагрузки циклов openmp по потокам
+//
+// время цикла показывает, какой schedule быстрее, но не почему. здесь для каждого
+// потока записывается:
+// - время работы (от входа в цикл до выхода из своей части)
+// - число итераций и порций schedule, доставшихся потоку
+// - время ожидания на барьере в конце цикла
+// в конце печатается коэффициент дисбаланса max/mean времени работы и гистограмма
+// по потокам
+//
+// порции считаются по размеру chunk, известному из директивы, без работы на итерации:
+// у schedule(static, N) и schedule(dynamic, N) все порции, кроме последней в цикле,
+// ровно по N итераций, поэтому у потока их ceil(итераций / N); у schedule(static)
+// без размера порция на поток одна (LOOP_CHUNK_STATIC). размер порций guided, auto
+// и runtime заранее не известен (LOOP_CHUNK_UNKNOWN): для них считаются непрерывные
+// отрезки номеров итераций - порции, доставшиеся потоку подряд, сливаются в один
+//
+// включается переменной окружения LOOP_PROFILE=1 (по умолчанию выключен).
+// выключенный профиль - NULL. включенный добавляет два omp_get_wtime на поток за цикл,
+// одну запись в свою кэш-линию и на каждой итерации - увеличение счетчика итераций
+// в регистре (у LOOP_CHUNK_UNKNOWN еще сравнение номера с предыдущим). на потоковых
+// циклах из одной операции на элемент итерацией служит блок элементов (task1, task3),
+// и счетчик срабатывает раз на блок - меньше 1% времени цикла
+//
+// использование - цикл с nowait и loop_probe_finish вместо неявного барьера.
+// LOOP_PROFILE_FOR разворачивается в два варианта цикла: при выключенном профиле
+// выполняется исходный цикл без счетчиков (стоимость - одна проверка на цикл при
+// любом уровне оптимизации), при включенном - со счетчиком на каждой итерации:
+//   loop_profile_t *profile = loop_profile_begin("имя");
+//   #pragma omp parallel
+//   {
+//       loop_probe_t probe = loop_probe_start(profile);
+//       LOOP_PROFILE_FOR(&probe, "omp for schedule(dynamic, 10) nowait",
+//                        (int i = 0; i < n; i++), i, 10,
+//           ...
+//       );
+//       loop_probe_finish(profile, &probe);  // барьер
+//   }
+//   loop_profile_report(profile);            // печать и освобождение
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define LOOP_PROFILE_BAR 40  // ширина гистограммы в символах
+
+// размер порции для LOOP_PROFILE_FOR, кроме явного N из директивы
+#define LOOP_CHUNK_UNKNOWN 0    // guided, auto, runtime: считаются непрерывные отрезки
+#define LOOP_CHUNK_STATIC (-1)  // schedule(static) без размера: одна порция на поток
+
+// итоги потока, каждый в своей кэш-линии
+typedef struct {
+    double busy;
+    double wait;
+    long iterations;
+    long chunks;
+    char pad[64 - 2 * sizeof(double) - 2 * sizeof(long)];
+} loop_thread_profile_t;
+
+typedef struct {
+    const char *name;
+    int threads;
+    int runs;                     // 1 - размер порции не известен, в chunks - отрезки
+    loop_thread_profile_t *slot;  // omp_get_max_threads() элементов
+} loop_profile_t;
+
+// счетчики потока внутри параллельной области (локальная переменная)
+typedef struct {
+    double start;
+    long iterations;
+    long runs;   // непрерывные отрезки номеров (LOOP_CHUNK_UNKNOWN)
+    long next;   // номер итерации, продолжающий текущий отрезок
+    long chunk;  // размер порции из LOOP_PROFILE_FOR
+    int enabled;
+} loop_probe_t;
+
+static inline int loop_profile_enabled(void) {
+    const char *env = getenv("LOOP_PROFILE");
+    return env != NULL && *env != '\0' && strcmp(env, "0") != 0;
+}
+
+// вызывается вне параллельной области; NULL, если профиль выключен или не хватило
+// памяти (тогда цикл выполняется без профиля)
+static inline loop_profile_t *loop_profile_begin(const char *name) {
+    if (!loop_profile_enabled()) return NULL;
+    loop_profile_t *p = (loop_profile_t *)malloc(sizeof(loop_profile_t));
+    if (p == NULL) {
+        fprintf(stderr, "профиль %s: не хватает памяти, цикл без профиля\n", name);
+        return NULL;
+    }
+    p->name = name;
+    p->threads = omp_get_max_threads();
+    p->runs = 0;
+    p->slot = (loop_thread_profile_t *)aligned_alloc(64, p->threads * sizeof(loop_thread_profile_t));
+    if (p->slot == NULL) {
+        fprintf(stderr, "профиль %s: не хватает памяти, цикл без профиля\n", name);
+        free(p);
+        return NULL;
+    }
+    memset(p->slot, 0, p->threads * sizeof(loop_thread_profile_t));
+    return p;
+}
+
+static inline loop_probe_t loop_probe_start(const loop_profile_t *p) {
+    loop_probe_t probe;
+    probe.start = p != NULL ? omp_get_wtime() : 0.0;
+    probe.iterations = 0;
+    probe.runs = 0;
+    probe.next = -1;
+    probe.chunk = LOOP_CHUNK_UNKNOWN;
+    probe.enabled = p != NULL;
+    return probe;
+}
+
+// итерация цикла с неизвестным размером порции: продолжает ли она текущий отрезок
+static inline void loop_probe_iteration(loop_probe_t *probe, long i) {
+    probe->runs += i != probe->next;
+    probe->next = i + 1;
+    probe->iterations++;
+}
+
+// число порций потока по размеру chunk (см. начало файла)
+static inline long loop_probe_chunks(const loop_probe_t *probe) {
+    if (probe->chunk == LOOP_CHUNK_UNKNOWN) return probe->runs;
+    if (probe->chunk == LOOP_CHUNK_STATIC) return probe->iterations > 0;
+    return (probe->iterations + probe->chunk - 1) / probe->chunk;
+}
+
+// конец своей части цикла: барьер (вместо неявного у omp for без nowait)
+// и запись итогов потока; вызывают все потоки области
+static inline void loop_probe_finish(loop_profile_t *p, const loop_probe_t *probe) {
+    if (p == NULL) {
+        #pragma omp barrier
+        return;
+    }
+    double done = omp_get_wtime();
+    #pragma omp barrier
+    double released = omp_get_wtime();
+    int tid = omp_get_thread_num();
+    if (tid == 0 && probe->chunk == LOOP_CHUNK_UNKNOWN) p->runs = 1;  // у всех потоков одинаково
+    if (tid < p->threads) {
+        loop_thread_profile_t *s = &p->slot[tid];
+        s->busy += done - probe->start;
+        s->wait += released - done;
+        s->iterations += probe->iterations;
+        s->chunks += loop_probe_chunks(probe);
+    }
+}
+
+// цикл omp for: header - заголовок for в скобках, index - номер итерации от 0
+// (у цикла с шагом - номер блока; нужен только при LOOP_CHUNK_UNKNOWN), chunk_size -
+// размер порции из directive в итерациях, LOOP_CHUNK_STATIC или LOOP_CHUNK_UNKNOWN,
+// тело - последний аргумент (может содержать запятые); directive - "omp for ... nowait",
+// барьер ставит loop_probe_finish
+#define LOOP_PROFILE_FOR(probe, directive, header, index, chunk_size, ...)      \
+    do {                                                                        \
+        if (!(probe)->enabled) {                                                \
+            _Pragma(directive)                                                  \
+            for header {                                                        \
+                __VA_ARGS__                                                     \
+            }                                                                   \
+        } else if ((chunk_size) == LOOP_CHUNK_UNKNOWN) {                        \
+            _Pragma(directive)                                                  \
+            for header {                                                        \
+                loop_probe_iteration((probe), (index));                         \
+                __VA_ARGS__                                                     \
+            }                                                                   \
+        } else {                                                                \
+            long loop_probe_count = 0;  /* в регистре, а не в структуре */      \
+            _Pragma(directive)                                                  \
+            for header {                                                        \
+                loop_probe_count++;                                             \
+                __VA_ARGS__                                                     \
+            }                                                                   \
+            (probe)->iterations += loop_probe_count;                            \
+            (probe)->chunk = (chunk_size);                                      \
+        }                                                                       \
+    } while (0)
+
+// таблица и гистограмма: '#' - работа, '.' - ожидание на барьере,
+// масштаб - самый долгий поток; освобождает профиль (NULL - ничего не делает)
+static inline void loop_profile_report(loop_profile_t *p) {
+    if (p == NULL) return;
+    int active = 0;
+    double max_busy = 0.0, sum_busy = 0.0, sum_wait = 0.0, span = 0.0;
+    for (int t = 0; t < p->threads; t++) {
+        const loop_thread_profile_t *s = &p->slot[t];
+        if (s->busy == 0.0 && s->wait == 0.0) continue;  // поток не участвовал
+        active++;
+        sum_busy += s->busy;
+        sum_wait += s->wait;
+        if (s->busy > max_busy) max_busy = s->busy;
+        if (s->busy + s->wait > span) span = s->busy + s->wait;
+    }
+    if (active > 0) {
+        double mean_busy = sum_busy / active;
+        printf("    профиль %s: дисбаланс max/mean = %.2f, ожидание на барьере %.1f%% времени потоков\n",
+               p->name, mean_busy > 0.0 ? max_busy / mean_busy : 1.0,
+               sum_busy + sum_wait > 0.0 ? 100.0 * sum_wait / (sum_busy + sum_wait) : 0.0);
+        for (int t = 0; t < p->threads; t++) {
+            const loop_thread_profile_t *s = &p->slot[t];
+            if (s->busy == 0.0 && s->wait == 0.0) continue;
+            int busy_len = span > 0.0 ? (int)(LOOP_PROFILE_BAR * s->busy / span + 0.5) : 0;
+            int wait_len = span > 0.0 ? (int)(LOOP_PROFILE_BAR * (s->busy + s->wait) / span + 0.5) - busy_len : 0;
+            char bar[LOOP_PROFILE_BAR + 1];
+            int k = 0;
+            for (; k < busy_len && k < LOOP_PROFILE_BAR; k++) bar[k] = '#';
+            for (; k < busy_len + wait_len && k < LOOP_PROFILE_BAR; k++) bar[k] = '.';
+            for (; k < LOOP_PROFILE_BAR; k++) bar[k] = ' ';
+            bar[LOOP_PROFILE_BAR] = '\0';
+            printf("      поток %3d |%s| работа %8.3f мс, ожидание %8.3f мс, итераций %ld, %s %ld\n",
+                   t, bar, s->busy * 1000, s->wait * 1000, s->iterations,
+                   p->runs ? "отрезков" : "порций", s->chunks);
+        }
+    }
+    free(p->slot);
+    free(p);
+}
+
+#endif // LOOP_PROFILE_H
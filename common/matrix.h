@@ -0,0 +1,72 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+// плотная матрица double в одном непрерывном буфере
+//
+// вместо double** с отдельным malloc на каждую строку (строки разбросаны по куче,
+// аппаратная предвыборка обрывается на границе строки, rows вызовов malloc при старте)
+// матрица - один буфер, выровненный по странице (и, значит, по 64 байтам), строка i
+// начинается с data + i * ld. ведущая размерность ld дополняется до кратной
+// MATRIX_ALIGN_ELEMS, поэтому каждая строка начинается на границе кэш-линии
+//
+// буфер выделяется numa_alloc_first_touch с элементом "строка": потоки касаются
+// своих строк с тем же schedule(static), что и циклы по строкам
+//
+// представления (matrix_block) ссылаются на чужой буфер с тем же ld и не освобождаются
+
+#include <stdlib.h>
+#include "numa_alloc.h"
+
+#define MATRIX_ALIGN 64                                    // байт: кэш-линия и вектор avx-512
+#define MATRIX_ALIGN_ELEMS (MATRIX_ALIGN / sizeof(double)) // 8 double
+
+typedef struct {
+    double *data;  // элемент (0, 0)
+    long rows;
+    long cols;
+    long ld;       // элементов от начала строки до начала следующей (>= cols)
+    int owner;     // 1 - буфер выделен этой матрицей, 0 - представление
+} matrix_t;
+
+// ведущая размерность для cols столбцов: вверх до кратной 8 double (64 байта)
+static inline long matrix_padded_ld(long cols) {
+    return (cols + MATRIX_ALIGN_ELEMS - 1) / MATRIX_ALIGN_ELEMS * MATRIX_ALIGN_ELEMS;
+}
+
+// одно выделение на всю матрицу, элементы (и дополнение строк) обнулены;
+// data == NULL - памяти не хватило
+static inline matrix_t matrix_alloc(long rows, long cols) {
+    matrix_t m;
+    m.rows = rows;
+    m.cols = cols;
+    m.ld = matrix_padded_ld(cols);
+    m.owner = 1;
+    m.data = (double *)numa_alloc_first_touch(rows, m.ld * sizeof(double));
+    return m;
+}
+
+static inline void matrix_free(matrix_t *m) {
+    if (m->owner) free(m->data);
+    m->data = NULL;
+}
+
+// строка i (представление строки - указатель на ее первый элемент, длина m->cols)
+static inline double *matrix_row(const matrix_t *m, long i) {
+    return m->data + i * m->ld;
+}
+
+// элемент (i, j)
+#define MATRIX_AT(m, i, j) ((m)->data[(long)(i) * (m)->ld + (j)])
+
+// представление блока rows x cols с левым верхним углом (r0, c0)
+static inline matrix_t matrix_block(const matrix_t *m, long r0, long c0, long rows, long cols) {
+    matrix_t v;
+    v.data = m->data + r0 * m->ld + c0;
+    v.rows = rows;
+    v.cols = cols;
+    v.ld = m->ld;
+    v.owner = 0;
+    return v;
+}
+
+#endif // MATRIX_H
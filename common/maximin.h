@@ -0,0 +1,397 @@
+#ifndef MAXIMIN_H
+#define MAXIMIN_H
+
+// максимум среди минимумов строк матрицы: общие ядра для заданий 4 и 9
+//
+// двумерное разбиение на плитки вместо вложенного parallel for: матрица делится на
+// плитки (блок строк x блок столбцов), каждая плитка - одна задача taskloop.
+// плитка пишет минимумы своих строк в собственные ячейки partial[i * col_blocks + cb],
+// поэтому объединение не требует ни блокировок, ни атомарных операций; после
+// taskloop (неявная taskgroup) минимумы строк сворачиваются редукцией max.
+// высокие узкие матрицы режутся по строкам, низкие широкие - еще и по столбцам,
+// так что задач хватает на все потоки без вложенных параллельных областей
+//
+// выбор стратегии по форме матрицы (maximin_plan):
+// - по строкам: parallel for по строкам - проваливается, когда строк меньше потоков
+// - по столбцам: поток t берет полосу столбцов во всех строках, частичные минимумы
+//   строк объединяются так же, как у плиток - проваливается на узких строках
+// - плитки: taskloop - накладные расходы на создание задач
+// время каждой стратегии предсказывается моделью с константами, один раз измеренными
+// на этой машине (maximin_calibration): время на элемент, на отрезок строки, на
+// параллельную область, на барьер и на задачу. MAXIMIN_STRATEGY=rows|columns|tiled
+// задает стратегию явно
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "matrix.h"
+
+#define MAXIMIN_TASKS_PER_THREAD 8   // плиток на поток - запас для балансировки
+#define MAXIMIN_MIN_TILE 4096        // элементов в плитке не меньше (накладные расходы задачи)
+#define MAXIMIN_MIN_TILE_COLS 256    // не дробить строку мельче (предвыборка, векторизация)
+
+typedef struct {
+    long tile_rows;
+    long tile_cols;
+    long row_blocks;
+    long col_blocks;
+} maximin_tiles_t;
+
+// минимум n элементов и init без ветвлений, 4 аккумулятора (minsd/minpd)
+static inline double maximin_block_min(const double *p, long n, double init) {
+    double m0 = init, m1 = init, m2 = init, m3 = init;
+    long j = 0;
+    for (; j + 4 <= n; j += 4) {
+        m0 = p[j] < m0 ? p[j] : m0;
+        m1 = p[j + 1] < m1 ? p[j + 1] : m1;
+        m2 = p[j + 2] < m2 ? p[j + 2] : m2;
+        m3 = p[j + 3] < m3 ? p[j + 3] : m3;
+    }
+    for (; j < n; j++) m0 = p[j] < m0 ? p[j] : m0;
+    m0 = m1 < m0 ? m1 : m0;
+    m2 = m3 < m2 ? m3 : m2;
+    return m2 < m0 ? m2 : m0;
+}
+
+// размер плиток для rows x cols и threads потоков: столбцы делятся, только если
+// строк меньше, чем нужно задач; ширина плитки кратна 8 double (строки выровнены)
+static inline maximin_tiles_t maximin_tiles_choose(long rows, long cols, int threads) {
+    maximin_tiles_t t;
+    long target = (long)threads * MAXIMIN_TASKS_PER_THREAD;
+    long elements = rows * cols / target;
+    if (elements < MAXIMIN_MIN_TILE) elements = MAXIMIN_MIN_TILE;
+
+    t.tile_cols = cols;
+    if (rows < target) {
+        long pieces = (target + rows - 1) / rows;
+        long width = (cols + pieces - 1) / pieces;
+        width = (width + MATRIX_ALIGN_ELEMS - 1) / MATRIX_ALIGN_ELEMS * MATRIX_ALIGN_ELEMS;
+        if (width < MAXIMIN_MIN_TILE_COLS) width = MAXIMIN_MIN_TILE_COLS;
+        if (width < cols) t.tile_cols = width;
+    }
+    t.tile_rows = elements / t.tile_cols;
+    if (t.tile_rows < 1) t.tile_rows = 1;
+    if (t.tile_rows > rows) t.tile_rows = rows;
+    t.row_blocks = (rows + t.tile_rows - 1) / t.tile_rows;
+    t.col_blocks = (cols + t.tile_cols - 1) / t.tile_cols;
+    return t;
+}
+
+// maximin по плиткам tiles; вызывается вне параллельной области
+static inline double maximin_tiled(const matrix_t *m, const maximin_tiles_t *tiles) {
+    long rows = m->rows, cols = m->cols;
+    long tr = tiles->tile_rows, tc = tiles->tile_cols, cb_count = tiles->col_blocks;
+    double *partial = (double *)malloc(rows * cb_count * sizeof(double));
+    if (partial == NULL) {
+        // без памяти под частичные минимумы - простой проход по строкам
+        double fallback = -INFINITY;
+        #pragma omp parallel for schedule(static) reduction(max:fallback)
+        for (long i = 0; i < rows; i++) {
+            const double *row = matrix_row(m, i);
+            double row_min = maximin_block_min(row, cols, row[0]);
+            if (row_min > fallback) fallback = row_min;
+        }
+        return fallback;
+    }
+    double result = -INFINITY;
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            #pragma omp taskloop collapse(2) grainsize(1)
+            for (long rb = 0; rb < tiles->row_blocks; rb++) {
+                for (long cb = 0; cb < cb_count; cb++) {
+                    long i_end = (rb + 1) * tr < rows ? (rb + 1) * tr : rows;
+                    long j0 = cb * tc;
+                    long width = cols - j0 < tc ? cols - j0 : tc;
+                    for (long i = rb * tr; i < i_end; i++) {
+                        const double *row = matrix_row(m, i) + j0;
+                        partial[i * cb_count + cb] = maximin_block_min(row, width, row[0]);
+                    }
+                }
+            }
+        }
+        // конец single - барьер: все плитки посчитаны
+
+        #pragma omp for schedule(static) reduction(max:result)
+        for (long i = 0; i < rows; i++) {
+            const double *p = partial + i * cb_count;
+            double row_min = maximin_block_min(p, cb_count, p[0]);
+            if (row_min > result) result = row_min;
+        }
+    }
+
+    free(partial);
+    return result;
+}
+
+// maximin параллельным циклом по строкам
+static inline double maximin_by_rows(const matrix_t *m) {
+    double result = -INFINITY;
+    #pragma omp parallel for schedule(static) reduction(max:result)
+    for (long i = 0; i < m->rows; i++) {
+        const double *row = matrix_row(m, i);
+        double row_min = maximin_block_min(row, m->cols, row[0]);
+        if (row_min > result) result = row_min;
+    }
+    return result;
+}
+
+// полос столбцов для стратегии "по столбцам": по одной на поток, но не уже 8 элементов
+static inline long maximin_column_stripes(long cols, int threads) {
+    long stripes = (cols + MATRIX_ALIGN_ELEMS - 1) / MATRIX_ALIGN_ELEMS;
+    return stripes < threads ? stripes : threads;
+}
+
+// maximin полосами столбцов: полоса s проходит все строки, минимумы строк по полосам
+// пишутся в partial[i * stripes + s] и сворачиваются после барьера
+static inline double maximin_by_columns(const matrix_t *m) {
+    long rows = m->rows, cols = m->cols;
+    long stripes = maximin_column_stripes(cols, omp_get_max_threads());
+    long width = (cols + stripes - 1) / stripes;
+    width = (width + MATRIX_ALIGN_ELEMS - 1) / MATRIX_ALIGN_ELEMS * MATRIX_ALIGN_ELEMS;
+    stripes = (cols + width - 1) / width;
+    double *partial = (double *)malloc(rows * stripes * sizeof(double));
+    if (partial == NULL) return maximin_by_rows(m);  // без памяти под частичные минимумы
+    double result = -INFINITY;
+
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static)
+        for (long s = 0; s < stripes; s++) {
+            long j0 = s * width;
+            long len = cols - j0 < width ? cols - j0 : width;
+            for (long i = 0; i < rows; i++) {
+                const double *row = matrix_row(m, i) + j0;
+                partial[i * stripes + s] = maximin_block_min(row, len, row[0]);
+            }
+        }
+
+        #pragma omp for schedule(static) reduction(max:result)
+        for (long i = 0; i < rows; i++) {
+            const double *p = partial + i * stripes;
+            double row_min = maximin_block_min(p, stripes, p[0]);
+            if (row_min > result) result = row_min;
+        }
+    }
+
+    free(partial);
+    return result;
+}
+
+typedef enum {
+    MAXIMIN_AUTO = 0,
+    MAXIMIN_ROWS = 1,
+    MAXIMIN_COLUMNS = 2,
+    MAXIMIN_TILED = 3
+} maximin_strategy_t;
+
+#define MAXIMIN_STRATEGIES 4
+
+static inline const char *maximin_strategy_name(maximin_strategy_t s) {
+    switch (s) {
+        case MAXIMIN_ROWS:    return "по строкам";
+        case MAXIMIN_COLUMNS: return "по столбцам";
+        case MAXIMIN_TILED:   return "плитки";
+        default:              return "авто";
+    }
+}
+
+// константы модели стоимости, секунды
+typedef struct {
+    double elem;     // один элемент в потоке (ядро maximin_block_min на данных вне кэша)
+    double speedup;  // ускорение того же просмотра всеми потоками (ядра, пропускная способность)
+    double segment;  // отрезок строки: вызов ядра, хвост, запись частичного минимума
+    double region;   // пустая параллельная область
+    double barrier;  // барьер
+    double task;     // создание и выполнение пустой задачи taskloop
+    int threads;
+} maximin_calibration_t;
+
+static maximin_calibration_t maximin_calibration_cached;
+static int maximin_calibration_valid = 0;
+
+// калибровка (один раз за запуск, около 0.05 секунды): лучшее из 3 замеров каждой величины
+// NULL - не хватило памяти под буфер замеров (следующий вызов попробует снова)
+static inline const maximin_calibration_t *maximin_calibration(void) {
+    if (maximin_calibration_valid) return &maximin_calibration_cached;
+    maximin_calibration_t c;
+    c.threads = omp_get_max_threads();
+    const long n = 1L << 21;  // 16 МБ - больше кэша второго уровня
+    const long short_len = 8, segments = n / short_len;
+    double *buf = (double *)malloc(n * sizeof(double));
+    if (buf == NULL) return NULL;
+    for (long i = 0; i < n; i++) buf[i] = (double)((i * 7919) % 100003);
+    volatile double sink = 0.0;
+    c.elem = c.segment = c.region = c.barrier = c.task = 1e30;
+
+    double parallel_elem = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        double start = omp_get_wtime();
+        sink = maximin_block_min(buf + 1, n - 1, buf[0]);
+        double t = (omp_get_wtime() - start) / n;
+        if (t < c.elem) c.elem = t;
+
+        // тот же массив всеми потоками поровну
+        start = omp_get_wtime();
+        #pragma omp parallel
+        {
+            long chunk = n / omp_get_num_threads(), first = omp_get_thread_num() * chunk;
+            double v = maximin_block_min(buf + first, chunk, buf[first]);
+            if (v == -1.0) sink = v;
+        }
+        t = (omp_get_wtime() - start) / n;
+        if (t < parallel_elem) parallel_elem = t;
+
+        // тот же объем короткими отрезками: разница - накладные расходы отрезка
+        start = omp_get_wtime();
+        double acc = 0.0;
+        for (long k = 0; k < segments; k++) acc += maximin_block_min(buf + k * short_len, short_len, buf[k]);
+        sink = acc;
+        t = (omp_get_wtime() - start) / segments - short_len * c.elem;
+        if (t < c.segment) c.segment = t;
+
+        const int regions = 200;
+        start = omp_get_wtime();
+        for (int k = 0; k < regions; k++) {
+            #pragma omp parallel
+            {
+                if (omp_get_thread_num() == -1) sink = 0.0;
+            }
+        }
+        t = (omp_get_wtime() - start) / regions;
+        if (t < c.region) c.region = t;
+
+        const int barriers = 1000;
+        start = omp_get_wtime();
+        #pragma omp parallel
+        {
+            for (int k = 0; k < barriers; k++) {
+                #pragma omp barrier
+            }
+        }
+        t = (omp_get_wtime() - start - c.region) / barriers;
+        if (t < c.barrier) c.barrier = t;
+
+        const long tasks = 2000;
+        start = omp_get_wtime();
+        #pragma omp parallel
+        {
+            #pragma omp single
+            {
+                #pragma omp taskloop grainsize(1)
+                for (long k = 0; k < tasks; k++) {
+                    if (k == -1) sink = 0.0;
+                }
+            }
+        }
+        t = (omp_get_wtime() - start - c.region) / tasks;
+        if (t < c.task) c.task = t;
+    }
+    (void)sink;
+    free(buf);
+    // область входит в замер параллельного просмотра - вычитаем ее
+    parallel_elem -= c.region / n;
+    c.speedup = parallel_elem > 0.0 ? c.elem / parallel_elem : c.threads;
+    if (c.speedup < 1.0) c.speedup = 1.0;
+    if (c.speedup > c.threads) c.speedup = c.threads;
+    if (c.segment < 0.0) c.segment = 0.0;
+    if (c.barrier < 0.0) c.barrier = 0.0;
+    if (c.task < 0.0) c.task = 0.0;
+
+    maximin_calibration_cached = c;
+    maximin_calibration_valid = 1;
+    return &maximin_calibration_cached;
+}
+
+static inline void maximin_print_calibration(const maximin_calibration_t *c) {
+    if (c == NULL) {
+        printf("модель стоимости: не откалибрована (не хватает памяти), стратегия rows\n");
+        return;
+    }
+    printf("модель стоимости (%d потоков): элемент %.2f нс, ускорение просмотра %.2fx, отрезок %.2f нс, "
+           "область %.2f мкс, барьер %.2f мкс, задача %.2f мкс\n", c->threads, c->elem * 1e9, c->speedup,
+           c->segment * 1e9, c->region * 1e6, c->barrier * 1e6, c->task * 1e6);
+}
+
+// прогноз времени стратегии s для rows x cols по модели c
+static inline double maximin_predict(const maximin_calibration_t *c, maximin_strategy_t s,
+                                     long rows, long cols) {
+    // работа самого загруженного потока растягивается в threads / speedup раз, когда
+    // потоков больше, чем ядер, или просмотр упирается в память
+    double p = c->threads, stretch = p / c->speedup;
+    switch (s) {
+        case MAXIMIN_ROWS:
+            // самый загруженный поток: ceil(rows / p) целых строк
+            return c->region + stretch * ceil(rows / p) * (c->segment + cols * c->elem);
+        case MAXIMIN_COLUMNS: {
+            // полоса шириной ceil(cols / stripes) во всех строках, затем свертка
+            long stripes = maximin_column_stripes(cols, c->threads);
+            double width = ceil((double)cols / stripes);
+            return c->region + stretch * rows * (c->segment + width * c->elem) + c->barrier
+                 + stretch * ceil(rows / p) * (c->segment + stripes * c->elem);
+        }
+        case MAXIMIN_TILED: {
+            // задачи создает один поток, плитки выполняют все
+            maximin_tiles_t t = maximin_tiles_choose(rows, cols, c->threads);
+            double tasks = (double)t.row_blocks * t.col_blocks;
+            return c->region + tasks * c->task
+                 + stretch * ceil(tasks / p) * t.tile_rows * (c->segment + t.tile_cols * c->elem)
+                 + c->barrier + stretch * ceil(rows / p) * (c->segment + t.col_blocks * c->elem);
+        }
+        default:
+            return INFINITY;
+    }
+}
+
+typedef struct {
+    maximin_strategy_t strategy;
+    double predicted[MAXIMIN_STRATEGIES];  // прогноз по стратегиям (индекс - maximin_strategy_t)
+    int forced;                            // стратегия задана MAXIMIN_STRATEGY
+    int calibrated;                        // 0 - калибровка не удалась, прогнозов нет, rows
+} maximin_plan_t;
+
+// выбор стратегии с наименьшим прогнозом (или заданной MAXIMIN_STRATEGY)
+static inline maximin_plan_t maximin_plan(long rows, long cols) {
+    const maximin_calibration_t *c = maximin_calibration();
+    maximin_plan_t plan;
+    plan.strategy = MAXIMIN_ROWS;
+    plan.forced = 0;
+    plan.calibrated = c != NULL;
+    plan.predicted[MAXIMIN_AUTO] = INFINITY;
+    for (int s = MAXIMIN_ROWS; s < MAXIMIN_STRATEGIES; s++) {
+        plan.predicted[s] = c != NULL ? maximin_predict(c, (maximin_strategy_t)s, rows, cols) : INFINITY;
+        if (plan.predicted[s] < plan.predicted[plan.strategy]) plan.strategy = (maximin_strategy_t)s;
+    }
+    const char *env = getenv("MAXIMIN_STRATEGY");
+    if (env != NULL) {
+        maximin_strategy_t forced = MAXIMIN_AUTO;
+        if (strcmp(env, "rows") == 0) forced = MAXIMIN_ROWS;
+        else if (strcmp(env, "columns") == 0) forced = MAXIMIN_COLUMNS;
+        else if (strcmp(env, "tiled") == 0) forced = MAXIMIN_TILED;
+        if (forced != MAXIMIN_AUTO) {
+            plan.strategy = forced;
+            plan.forced = 1;
+        }
+    }
+    return plan;
+}
+
+// maximin выбранной стратегией; вызывается вне параллельной области
+static inline double maximin_run(const matrix_t *m, maximin_strategy_t s) {
+    switch (s) {
+        case MAXIMIN_COLUMNS:
+            return maximin_by_columns(m);
+        case MAXIMIN_TILED: {
+            maximin_tiles_t t = maximin_tiles_choose(m->rows, m->cols, omp_get_max_threads());
+            return maximin_tiled(m, &t);
+        }
+        default:
+            return maximin_by_rows(m);
+    }
+}
+
+#endif // MAXIMIN_H
@@ -0,0 +1,259 @@
+#ifndef MIXED_DOT_H
+#define MIXED_DOT_H
+
+// скалярное произведение со смешанной точностью
+// скалярное произведение упирается в пропускную способность памяти, поэтому
+// хранение векторов в более узком типе почти пропорционально ускоряет его:
+// - double:  хранение double, накопление double (эталон)
+// - float:   хранение float (4 байта), накопление double
+// - bf16:    хранение bfloat16 (2 байта, старшие 16 бит float), накопление float
+//            внутри блока DOT_BF16_BLOCK, суммы блоков складываются в double
+// реализация выбирается один раз во время выполнения по cpuid (avx2+fma -> скалярная)
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIXED_DOT_X86 1
+#endif
+
+#define DOT_BF16_BLOCK 1024  // элементов на одну float-сумму (ограничивает накопление ошибки)
+
+typedef uint16_t bf16_t;
+
+typedef enum {
+    DOT_DOUBLE = 0,
+    DOT_FLOAT = 1,
+    DOT_BF16 = 2,
+    DOT_NUM_PRECISIONS = 3
+} dot_precision_t;
+
+// размер одного элемента хранения в байтах
+static inline size_t dot_elem_size(dot_precision_t p) {
+    switch (p) {
+        case DOT_FLOAT: return sizeof(float);
+        case DOT_BF16:  return sizeof(bf16_t);
+        default:        return sizeof(double);
+    }
+}
+
+static inline const char *dot_precision_name(dot_precision_t p) {
+    switch (p) {
+        case DOT_FLOAT: return "float";
+        case DOT_BF16:  return "bf16";
+        default:        return "double";
+    }
+}
+
+// разбор имени из командной строки, -1 если имя неизвестно
+static inline int dot_precision_from_name(const char *name) {
+    for (int p = 0; p < DOT_NUM_PRECISIONS; p++) {
+        if (strcmp(name, dot_precision_name((dot_precision_t)p)) == 0) return p;
+    }
+    return -1;
+}
+
+// float -> bf16 с округлением к ближайшему четному (nan остается nan)
+static inline bf16_t float_to_bf16(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7FFFFFFFu) > 0x7F800000u) return (bf16_t)((u >> 16) | 0x40);
+    u += 0x7FFFu + ((u >> 16) & 1u);
+    return (bf16_t)(u >> 16);
+}
+
+static inline float bf16_to_float(bf16_t h) {
+    uint32_t u = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// преобразование массива double в тип хранения (dst на n * dot_elem_size(p) байт)
+static inline void dot_convert(void *dst, const double *src, long n, dot_precision_t p) {
+    if (p == DOT_FLOAT) {
+        float *d = (float *)dst;
+        for (long i = 0; i < n; i++) d[i] = (float)src[i];
+    } else if (p == DOT_BF16) {
+        bf16_t *d = (bf16_t *)dst;
+        for (long i = 0; i < n; i++) d[i] = float_to_bf16((float)src[i]);
+    } else {
+        memcpy(dst, src, (size_t)n * sizeof(double));
+    }
+}
+
+// скалярные версии (4 аккумулятора)
+
+static inline double dot_f64_scalar(const double *x, const double *y, long n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < n; i++) s0 += x[i] * y[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static inline double dot_f32_scalar(const float *x, const float *y, long n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += (double)x[i] * y[i];
+        s1 += (double)x[i + 1] * y[i + 1];
+        s2 += (double)x[i + 2] * y[i + 2];
+        s3 += (double)x[i + 3] * y[i + 3];
+    }
+    for (; i < n; i++) s0 += (double)x[i] * y[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static inline double dot_bf16_scalar(const bf16_t *x, const bf16_t *y, long n) {
+    double total = 0.0;
+    for (long lo = 0; lo < n; lo += DOT_BF16_BLOCK) {
+        long hi = (n - lo < DOT_BF16_BLOCK) ? n : lo + DOT_BF16_BLOCK;
+        float s = 0.0f;
+        for (long i = lo; i < hi; i++) s += bf16_to_float(x[i]) * bf16_to_float(y[i]);
+        total += s;
+    }
+    return total;
+}
+
+#ifdef MIXED_DOT_X86
+
+// avx2 + fma: 4 регистра по 4 double = 16 элементов за итерацию
+__attribute__((target("avx2,fma")))
+static inline double dot_f64_avx2(const double *x, const double *y, long n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i),      _mm256_loadu_pd(y + i),      s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4),  _mm256_loadu_pd(y + i + 4),  s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8),  _mm256_loadu_pd(y + i + 8),  s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), s3);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    double s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) s += x[i] * y[i];
+    return s;
+}
+
+// float -> double через vcvtps2pd: 16 float за итерацию, накопление в 4 регистрах double
+__attribute__((target("avx2,fma")))
+static inline double dot_f32_avx2(const float *x, const float *y, long n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_loadu_ps(x + i), a1 = _mm256_loadu_ps(x + i + 8);
+        __m256 b0 = _mm256_loadu_ps(y + i), b1 = _mm256_loadu_ps(y + i + 8);
+        s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a0)),
+                             _mm256_cvtps_pd(_mm256_castps256_ps128(b0)), s0);
+        s1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a0, 1)),
+                             _mm256_cvtps_pd(_mm256_extractf128_ps(b0, 1)), s1);
+        s2 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a1)),
+                             _mm256_cvtps_pd(_mm256_castps256_ps128(b1)), s2);
+        s3 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a1, 1)),
+                             _mm256_cvtps_pd(_mm256_extractf128_ps(b1, 1)), s3);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    double s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) s += (double)x[i] * y[i];
+    return s;
+}
+
+// 8 значений bf16 -> 8 float: расширение до 32 бит и сдвиг в старшую половину
+__attribute__((target("avx2")))
+static inline __m256 dot_bf16x8_to_ps(const bf16_t *p) {
+    __m128i h = _mm_loadu_si128((const __m128i *)p);
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+}
+
+// bf16 -> float: 16 элементов за итерацию, 2 регистра float на блок DOT_BF16_BLOCK
+__attribute__((target("avx2,fma")))
+static inline double dot_bf16_avx2(const bf16_t *x, const bf16_t *y, long n) {
+    double total = 0.0;
+    long i = 0;
+    while (i + 16 <= n) {
+        long hi = (n - i < DOT_BF16_BLOCK) ? i + (n - i) / 16 * 16 : i + DOT_BF16_BLOCK;
+        __m256 s0 = _mm256_setzero_ps(), s1 = s0;
+        for (; i < hi; i += 16) {
+            s0 = _mm256_fmadd_ps(dot_bf16x8_to_ps(x + i),     dot_bf16x8_to_ps(y + i),     s0);
+            s1 = _mm256_fmadd_ps(dot_bf16x8_to_ps(x + i + 8), dot_bf16x8_to_ps(y + i + 8), s1);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, _mm256_add_ps(s0, s1));
+        total += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                 ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    float tail = 0.0f;
+    for (; i < n; i++) tail += bf16_to_float(x[i]) * bf16_to_float(y[i]);
+    return total + tail;
+}
+
+#endif // MIXED_DOT_X86
+
+typedef double (*dot_kernel_t)(const void *x, const void *y, long n);
+
+// обертки с общей сигнатурой для таблицы ядер
+static inline double dot_f64_scalar_v(const void *x, const void *y, long n) {
+    return dot_f64_scalar((const double *)x, (const double *)y, n);
+}
+static inline double dot_f32_scalar_v(const void *x, const void *y, long n) {
+    return dot_f32_scalar((const float *)x, (const float *)y, n);
+}
+static inline double dot_bf16_scalar_v(const void *x, const void *y, long n) {
+    return dot_bf16_scalar((const bf16_t *)x, (const bf16_t *)y, n);
+}
+#ifdef MIXED_DOT_X86
+static inline double dot_f64_avx2_v(const void *x, const void *y, long n) {
+    return dot_f64_avx2((const double *)x, (const double *)y, n);
+}
+static inline double dot_f32_avx2_v(const void *x, const void *y, long n) {
+    return dot_f32_avx2((const float *)x, (const float *)y, n);
+}
+static inline double dot_bf16_avx2_v(const void *x, const void *y, long n) {
+    return dot_bf16_avx2((const bf16_t *)x, (const bf16_t *)y, n);
+}
+#endif
+
+static dot_kernel_t dot_selected_kernels[DOT_NUM_PRECISIONS] = {NULL, NULL, NULL};
+static const char *dot_selected_name = "scalar";
+
+// выбор реализации для всех типов (вызывается один раз, дальше берется из кэша)
+static inline void dot_select_kernels(void) {
+    if (dot_selected_kernels[0] != NULL) return;
+    dot_kernel_t k[DOT_NUM_PRECISIONS] = {dot_f64_scalar_v, dot_f32_scalar_v, dot_bf16_scalar_v};
+    const char *name = "scalar";
+#ifdef MIXED_DOT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        k[DOT_DOUBLE] = dot_f64_avx2_v;
+        k[DOT_FLOAT] = dot_f32_avx2_v;
+        k[DOT_BF16] = dot_bf16_avx2_v;
+        name = "avx2+fma";
+    }
+#endif
+    dot_selected_name = name;
+    for (int p = DOT_NUM_PRECISIONS - 1; p >= 0; p--) {  // элемент 0 - признак готовности, пишется последним
+        dot_selected_kernels[p] = k[p];
+    }
+}
+
+// название выбранного набора инструкций (для отчета)
+static inline const char *dot_kernel_name(void) {
+    dot_select_kernels();
+    return dot_selected_name;
+}
+
+// основная точка входа: x и y хранятся в типе p, результат в double
+static inline double dot_typed(const void *x, const void *y, long n, dot_precision_t p) {
+    dot_select_kernels();
+    return dot_selected_kernels[p](x, y, n);
+}
+
+#endif // MIXED_DOT_H
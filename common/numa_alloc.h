@@ -0,0 +1,157 @@
+#ifndef NUMA_ALLOC_H
+#define NUMA_ALLOC_H
+
+// numa-aware выделение памяти и отчет о привязке потоков
+//
+// linux размещает страницу на узле numa того потока, который первым в нее пишет
+// (first touch). если массив заполняет главный поток, все страницы оказываются
+// на сокете 0 и потоки второго сокета читают память через межсокетную шину.
+// numa_alloc_first_touch касается памяти параллельно с тем же schedule(static),
+// что и вычислительные циклы, поэтому каждый поток потом читает свою локальную память
+//
+// привязка потоков задается стандартными переменными openmp, например:
+//   OMP_PLACES=cores OMP_PROC_BIND=spread ./min_max
+// numa_print_binding выводит текущую конфигурацию и cpu/узел каждого потока
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <omp.h>
+
+#define NUMA_ALIGNMENT 4096  // выравнивание по странице - граница блока потока не делит страницу с соседом
+#define NUMA_MAX_NODES 64
+
+// замер одного потока для отчета о пропускной способности по сокетам
+typedef struct {
+    int cpu;         // логический процессор, на котором работал поток
+    int node;        // узел numa (сокет)
+    double bytes;    // прочитано байт
+    double seconds;  // время работы потока
+} numa_thread_bw_t;
+
+// текущий cpu и узел numa вызывающего потока (getcpu), 0 если вызов недоступен
+static inline int numa_current_node(int *cpu) {
+    unsigned int c = 0, node = 0;
+#ifdef SYS_getcpu
+    if (syscall(SYS_getcpu, &c, &node, NULL) != 0) {
+        c = 0;
+        node = 0;
+    }
+#endif
+    if (cpu != NULL) *cpu = (int)c;
+    return (int)node;
+}
+
+// диапазон [begin, end) итераций 0..n-1, который schedule(static) без chunk
+// отдает текущему потоку (разбиение libgomp и llvm: первые n % nthreads потоков
+// получают на одну итерацию больше) - для циклов, где блок потока обрабатывается целиком
+static inline void numa_static_range(long n, long *begin, long *end) {
+    long nthreads = omp_get_num_threads();
+    long tid = omp_get_thread_num();
+    long q = n / nthreads, r = n % nthreads;
+    *begin = tid * q + (tid < r ? tid : r);
+    *end = *begin + q + (tid < r ? 1 : 0);
+}
+
+// запись замера текущего потока; только две записи в память - системный вызов getcpu
+// выполняется позже, вне замеряемой области (numa_print_socket_bandwidth)
+static inline void numa_record(numa_thread_bw_t *slot, double bytes, double seconds) {
+    slot->bytes = bytes;
+    slot->seconds = seconds;
+}
+
+// выделение памяти с параллельным первым касанием по schedule(static)
+// элементы обнуляются; освобождать через free()
+static inline void *numa_alloc_first_touch(long count, size_t elem_size) {
+    size_t bytes = (size_t)count * elem_size;
+    size_t rounded = (bytes + NUMA_ALIGNMENT - 1) / NUMA_ALIGNMENT * NUMA_ALIGNMENT;
+    if (rounded == 0) rounded = NUMA_ALIGNMENT;
+
+    char *ptr = (char *)aligned_alloc(NUMA_ALIGNMENT, rounded);
+    if (ptr == NULL) return NULL;
+
+    // каждый поток касается того блока элементов, который ему потом отдаст schedule(static)
+    #pragma omp parallel
+    {
+        long begin, end;
+        numa_static_range(count, &begin, &end);
+        if (end > begin) {
+            memset(ptr + (size_t)begin * elem_size, 0, (size_t)(end - begin) * elem_size);
+        }
+    }
+    return ptr;
+}
+
+static inline const char *numa_proc_bind_name(omp_proc_bind_t bind) {
+    switch (bind) {
+        case omp_proc_bind_false:  return "false";
+        case omp_proc_bind_true:   return "true";
+        case omp_proc_bind_master: return "master";
+        case omp_proc_bind_close:  return "close";
+        case omp_proc_bind_spread: return "spread";
+        default:                   return "unknown";
+    }
+}
+
+// вывод конфигурации привязки: OMP_PLACES, proc_bind, место/cpu/узел каждого потока
+static inline void numa_print_binding(void) {
+    const char *places = getenv("OMP_PLACES");
+    printf("привязка потоков: OMP_PLACES=%s, proc_bind=%s, мест: %d\n",
+           places ? places : "(не задано)", numa_proc_bind_name(omp_get_proc_bind()),
+           omp_get_num_places());
+
+    #pragma omp parallel
+    {
+        int cpu;
+        int node = numa_current_node(&cpu);
+        #pragma omp for ordered schedule(static, 1)
+        for (int t = 0; t < omp_get_num_threads(); t++) {
+            #pragma omp ordered
+            printf("  поток %2d: место %2d, cpu %3d, узел numa %d\n",
+                   omp_get_thread_num(), omp_get_place_num(), cpu, node);
+        }
+    }
+}
+
+// сводка пропускной способности по сокетам:
+// объем, прочитанный потоками узла, делится на время самого медленного из них.
+// cpu и узел потоков определяются здесь, в отдельной параллельной области той же
+// ширины: при OMP_PROC_BIND поток с тем же номером остается на том же месте.
+// t == NULL (массив замеров не выделен) - сводка пропускается
+static inline void numa_print_socket_bandwidth(numa_thread_bw_t *t, int nthreads) {
+    if (t == NULL) {
+        printf("  пропускная способность по сокетам: пропущено, не хватает памяти под замеры\n");
+        return;
+    }
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int tid = omp_get_thread_num();
+        if (tid < nthreads) t[tid].node = numa_current_node(&t[tid].cpu);
+    }
+
+    double node_bytes[NUMA_MAX_NODES] = {0};
+    double node_time[NUMA_MAX_NODES] = {0};
+    int node_threads[NUMA_MAX_NODES] = {0};
+    double total_bytes = 0.0, total_time = 0.0;
+
+    for (int i = 0; i < nthreads; i++) {
+        int node = (t[i].node >= 0 && t[i].node < NUMA_MAX_NODES) ? t[i].node : 0;
+        node_bytes[node] += t[i].bytes;
+        if (t[i].seconds > node_time[node]) node_time[node] = t[i].seconds;
+        node_threads[node]++;
+        total_bytes += t[i].bytes;
+        if (t[i].seconds > total_time) total_time = t[i].seconds;
+    }
+
+    printf("  пропускная способность по сокетам:\n");
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        if (node_threads[node] == 0) continue;
+        printf("    узел %d: потоков %2d, %.2f ГБ/с\n", node, node_threads[node],
+               node_time[node] > 0.0 ? node_bytes[node] / node_time[node] / 1e9 : 0.0);
+    }
+    printf("    всего: %.2f ГБ/с\n", total_time > 0.0 ? total_bytes / total_time / 1e9 : 0.0);
+}
+
+#endif // NUMA_ALLOC_H
@@ -0,0 +1,123 @@
+#ifndef PHILOX_RNG_H
+#define PHILOX_RNG_H
+
+// счетчиковый генератор случайных чисел philox4x32-10 (salmon et al., 2011)
+// значение элемента с номером i зависит только от (seed, stream, i),
+// поэтому любой поток может начать генерацию с любого места без общего состояния:
+// параллельное заполнение дает одинаковые данные при любом числе потоков
+//
+// один вызов philox дает 128 бит = 2 числа double с 53-битной мантиссой
+
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+#define RNG_DEFAULT_SEED 20240901ULL
+
+typedef struct {
+    uint32_t v[4];
+} philox4x32_t;
+
+// 10 раундов philox: counter = (номер блока, поток), key = seed
+static inline philox4x32_t philox4x32_10(uint64_t block, uint64_t stream, uint64_t seed) {
+    uint32_t c0 = (uint32_t)block, c1 = (uint32_t)(block >> 32);
+    uint32_t c2 = (uint32_t)stream, c3 = (uint32_t)(stream >> 32);
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+
+    for (int r = 0; r < 10; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    philox4x32_t out = {{c0, c1, c2, c3}};
+    return out;
+}
+
+// 64 случайных бита -> double в [0, 1) со всеми 53 битами мантиссы
+static inline double rng_bits_to_unit(uint32_t lo, uint32_t hi) {
+    uint64_t x = ((uint64_t)hi << 32) | lo;
+    return (double)(int64_t)(x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// одно равномерное число из [0, 1) для элемента index
+static inline double rng_uniform_at(uint64_t seed, uint64_t stream, uint64_t index) {
+    philox4x32_t r = philox4x32_10(index >> 1, stream, seed);
+    return (index & 1) ? rng_bits_to_unit(r.v[2], r.v[3]) : rng_bits_to_unit(r.v[0], r.v[1]);
+}
+
+// последовательное заполнение arr[0..n) элементами first_index..first_index+n
+// равномерно распределенными числами из [lo, hi)
+// основной цикл без ветвлений, компилятор векторизует его при -O3
+static inline void rng_fill_range(double *arr, long n, uint64_t seed, uint64_t stream,
+                                  uint64_t first_index, double lo, double hi) {
+    double scale = hi - lo;
+    long i = 0;
+
+    if (n > 0 && (first_index & 1)) {  // начало не совпадает с границей блока philox
+        arr[0] = lo + scale * rng_uniform_at(seed, stream, first_index);
+        i = 1;
+    }
+
+    uint64_t block0 = (first_index + i) >> 1;
+    long pairs = (n - i) / 2;
+    double *out = arr + i;
+    for (long b = 0; b < pairs; b++) {
+        philox4x32_t r = philox4x32_10(block0 + b, stream, seed);
+        out[2 * b]     = lo + scale * rng_bits_to_unit(r.v[0], r.v[1]);
+        out[2 * b + 1] = lo + scale * rng_bits_to_unit(r.v[2], r.v[3]);
+    }
+    i += 2 * pairs;
+
+    if (i < n) {  // хвост из одного элемента
+        arr[i] = lo + scale * rng_uniform_at(seed, stream, first_index + i);
+    }
+}
+
+// параллельное заполнение массива: каждый поток прыгает сразу на свое смещение
+// результат побитово совпадает с последовательным rng_fill_range
+static inline void rng_fill_uniform(double *arr, long n, uint64_t seed, uint64_t stream,
+                                    double lo, double hi) {
+    #pragma omp parallel
+    {
+#ifdef _OPENMP
+        int nthreads = omp_get_num_threads();
+        int tid = omp_get_thread_num();
+#else
+        int nthreads = 1;
+        int tid = 0;
+#endif
+        // границы блоков кратны 2, чтобы пары philox не делились между потоками
+        long begin = (n * tid / nthreads) & ~1L;
+        long end = (tid == nthreads - 1) ? n : ((n * (tid + 1) / nthreads) & ~1L);
+        if (end > begin) {
+            rng_fill_range(arr + begin, end - begin, seed, stream, (uint64_t)begin, lo, hi);
+        }
+    }
+}
+
+// seed берется из переменной окружения RNG_SEED, иначе используется фиксированный
+// (запуски с одинаковым seed воспроизводимы)
+static inline uint64_t rng_seed_from_env(void) {
+    const char *env = getenv("RNG_SEED");
+    if (env != NULL && *env != '\0') {
+        return strtoull(env, NULL, 10);
+    }
+    return RNG_DEFAULT_SEED;
+}
+
+#endif // PHILOX_RNG_H
@@ -0,0 +1,285 @@
+#ifndef QMC_H
+#define QMC_H
+
+// квази-монте-карло интегрирование по единичному кубу [0, 1]^dim
+//
+// точки - последовательности с низким расхождением:
+// - sobol: 32-битные направляющие числа (примитивные многочлены и начальные m
+//   из таблицы джо-куо), порядок грея; точка с номером i вычисляется напрямую
+//   (xor направляющих чисел по битам кода грея i), следующие - одним xor
+//   (антонов-салеев), поэтому любой поток или процесс начинает с любого номера
+// - halton: обратные по основаниям-простым числам, номер i вычисляется напрямую
+//
+// оценка погрешности - по случайным сдвигам: один и тот же набор из N точек
+// сдвигается QMC_MAX_SHIFTS раз или меньше (sobol - цифровой сдвиг xor, halton -
+// сдвиг по модулю 1, сдвиги из philox), оценки по сдвигам независимы, их разброс дает
+// стандартную ошибку среднего
+//
+// подынтегральная функция вычисляется блоками точек: fn(u, fu, count, dim, ctx),
+// u - count x dim по строкам
+//
+// при подключении после <mpi.h> доступен qmc_integrate_mpi: номера точек
+// делятся между процессами непрерывными кусками, суммы по сдвигам - MPI_Allreduce
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "philox_rng.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define QMC_MAX_DIM 16
+#define QMC_MAX_SHIFTS 64
+#define QMC_BITS 32
+#define QMC_BLOCK 256   // точек в блоке: генерация, вычисление функции и сумма
+#define QMC_RNG_STREAM 100  // поток philox для сдвигов
+
+typedef enum {
+    QMC_SOBOL = 0,
+    QMC_HALTON = 1
+} qmc_sequence_t;
+
+// как складываются суммы блоков (для отчета в формате integral.c)
+typedef enum {
+    QMC_SEQUENTIAL = 0,
+    QMC_REDUCTION = 1,   // omp parallel for reduction по массиву сумм
+    QMC_CRITICAL = 2     // локальные суммы потоков, сложение в критической секции
+} qmc_mode_t;
+
+typedef void (*qmc_fn_t)(const double *u, double *fu, int count, int dim, void *ctx);
+
+typedef struct {
+    qmc_sequence_t sequence;
+    int dim;
+    long points;      // точек на один сдвиг
+    int shifts;       // число случайных сдвигов (>= 2 для оценки погрешности)
+    uint64_t seed;
+} qmc_config_t;
+
+typedef struct {
+    double estimate;  // среднее по сдвигам
+    double error;     // стандартная ошибка среднего по сдвигам
+    long evaluations; // вычислений функции (points * shifts)
+} qmc_result_t;
+
+// примитивные многочлены (степень s, средние коэффициенты a) и начальные m
+// для измерений 2..16 (new-joe-kuo-6.21201); измерение 1 - van der corput
+static const struct {
+    int s, a;
+    unsigned m[6];
+} qmc_sobol_init[QMC_MAX_DIM - 1] = {
+    {1, 0,  {1}},
+    {2, 1,  {1, 3}},
+    {3, 1,  {1, 3, 1}},
+    {3, 2,  {1, 1, 1}},
+    {4, 1,  {1, 1, 3, 3}},
+    {4, 4,  {1, 3, 5, 13}},
+    {5, 2,  {1, 1, 5, 5, 17}},
+    {5, 4,  {1, 1, 5, 5, 5}},
+    {5, 7,  {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1,  {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+};
+
+static const unsigned qmc_primes[QMC_MAX_DIM] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+
+// направляющие числа v[d][k] (бит k номера в коде грея)
+static uint32_t qmc_sobol_v[QMC_MAX_DIM][QMC_BITS];
+static int qmc_sobol_ready = 0;
+
+static inline void qmc_sobol_init_table(void) {
+    if (qmc_sobol_ready) return;
+    for (int k = 0; k < QMC_BITS; k++) qmc_sobol_v[0][k] = 1u << (QMC_BITS - 1 - k);
+    for (int d = 1; d < QMC_MAX_DIM; d++) {
+        int s = qmc_sobol_init[d - 1].s, a = qmc_sobol_init[d - 1].a;
+        uint32_t *v = qmc_sobol_v[d];
+        for (int k = 0; k < s; k++) v[k] = qmc_sobol_init[d - 1].m[k] << (QMC_BITS - 1 - k);
+        for (int k = s; k < QMC_BITS; k++) {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for (int j = 1; j < s; j++) {
+                if ((a >> (s - 1 - j)) & 1) v[k] ^= v[k - j];
+            }
+        }
+    }
+    qmc_sobol_ready = 1;
+}
+
+static inline const char *qmc_sequence_name(qmc_sequence_t s) {
+    return s == QMC_HALTON ? "halton" : "sobol";
+}
+
+// точка sobol с номером i напрямую: xor направляющих чисел по битам кода грея
+static inline void qmc_sobol_at(long i, int dim, uint32_t *x) {
+    uint64_t g = (uint64_t)i ^ ((uint64_t)i >> 1);
+    for (int d = 0; d < dim; d++) x[d] = 0;
+    for (int k = 0; g != 0; k++, g >>= 1) {
+        if (g & 1) {
+            for (int d = 0; d < dim; d++) x[d] ^= qmc_sobol_v[d][k];
+        }
+    }
+}
+
+// обратное по основанию base: цифры номера в обратном порядке после запятой
+static inline double qmc_radical_inverse(long i, unsigned base) {
+    double inv = 1.0 / base, scale = inv, r = 0.0;
+    for (unsigned long n = (unsigned long)i; n > 0; n /= base) {
+        r += (double)(n % base) * scale;
+        scale *= inv;
+    }
+    return r;
+}
+
+// сдвиги: для sobol - 32 случайных бита на измерение, для halton - число из [0, 1)
+typedef struct {
+    uint32_t bits[QMC_MAX_SHIFTS][QMC_MAX_DIM];
+    double offset[QMC_MAX_SHIFTS][QMC_MAX_DIM];
+} qmc_shifts_t;
+
+static inline void qmc_make_shifts(const qmc_config_t *cfg, qmc_shifts_t *sh) {
+    for (int r = 0; r < cfg->shifts; r++) {
+        for (int d = 0; d < cfg->dim; d++) {
+            uint64_t idx = (uint64_t)r * QMC_MAX_DIM + d;
+            philox4x32_t bits = philox4x32_10(idx, QMC_RNG_STREAM, cfg->seed);
+            sh->bits[r][d] = bits.v[0];
+            sh->offset[r][d] = rng_bits_to_unit(bits.v[1], bits.v[2]);
+        }
+    }
+}
+
+// суммы функции по точкам [lo, lo + count) (count <= QMC_BLOCK) для каждого сдвига:
+// точки без сдвига генерируются один раз на блок, сдвиги применяются к ним
+static inline void qmc_block_sums(const qmc_config_t *cfg, const qmc_shifts_t *sh, qmc_fn_t fn,
+                                  void *ctx, long lo, int count, double *sums) {
+    const int dim = cfg->dim;
+    double u[QMC_BLOCK * QMC_MAX_DIM], fu[QMC_BLOCK];
+
+    if (cfg->sequence == QMC_SOBOL) {
+        uint32_t x[QMC_BLOCK * QMC_MAX_DIM];
+        qmc_sobol_at(lo, dim, x);  // прыжок к началу блока
+        for (int p = 1; p < count; p++) {
+            // следующая точка в порядке грея: меняется бит ctz(i) номера i = lo + p
+            int k = __builtin_ctzl((unsigned long)(lo + p));
+            for (int d = 0; d < dim; d++) x[p * dim + d] = x[(p - 1) * dim + d] ^ qmc_sobol_v[d][k];
+        }
+        for (int r = 0; r < cfg->shifts; r++) {
+            const uint32_t *bits = sh->bits[r];
+            for (int p = 0; p < count; p++) {
+                for (int d = 0; d < dim; d++) {
+                    // середина двоичного интервала: точка никогда не равна 0 или 1
+                    u[p * dim + d] = ((double)(x[p * dim + d] ^ bits[d]) + 0.5) * (1.0 / 4294967296.0);
+                }
+            }
+            fn(u, fu, count, dim, ctx);
+            double s = 0.0;
+            for (int p = 0; p < count; p++) s += fu[p];
+            sums[r] += s;
+        }
+    } else {
+        double h[QMC_BLOCK * QMC_MAX_DIM];
+        for (int p = 0; p < count; p++) {
+            for (int d = 0; d < dim; d++) h[p * dim + d] = qmc_radical_inverse(lo + p + 1, qmc_primes[d]);
+        }
+        for (int r = 0; r < cfg->shifts; r++) {
+            const double *off = sh->offset[r];
+            for (int p = 0; p < count; p++) {
+                for (int d = 0; d < dim; d++) {
+                    double v = h[p * dim + d] + off[d];
+                    u[p * dim + d] = v >= 1.0 ? v - 1.0 : v;
+                }
+            }
+            fn(u, fu, count, dim, ctx);
+            double s = 0.0;
+            for (int p = 0; p < count; p++) s += fu[p];
+            sums[r] += s;
+        }
+    }
+}
+
+// суммы по точкам [begin, end) для каждого сдвига (sums - cfg->shifts элементов)
+static inline void qmc_sums(const qmc_config_t *cfg, qmc_fn_t fn, void *ctx,
+                            long begin, long end, qmc_mode_t mode, double *sums) {
+    qmc_shifts_t sh;
+    qmc_sobol_init_table();
+    qmc_make_shifts(cfg, &sh);
+    const int shifts = cfg->shifts;
+    long nblocks = (end - begin + QMC_BLOCK - 1) / QMC_BLOCK;
+    for (int r = 0; r < shifts; r++) sums[r] = 0.0;
+
+    if (mode == QMC_SEQUENTIAL) {
+        for (long b = 0; b < nblocks; b++) {
+            long lo = begin + b * QMC_BLOCK;
+            int count = (int)(end - lo < QMC_BLOCK ? end - lo : QMC_BLOCK);
+            qmc_block_sums(cfg, &sh, fn, ctx, lo, count, sums);
+        }
+    } else if (mode == QMC_REDUCTION) {
+        #pragma omp parallel for schedule(static) reduction(+:sums[:shifts])
+        for (long b = 0; b < nblocks; b++) {
+            long lo = begin + b * QMC_BLOCK;
+            int count = (int)(end - lo < QMC_BLOCK ? end - lo : QMC_BLOCK);
+            qmc_block_sums(cfg, &sh, fn, ctx, lo, count, sums);
+        }
+    } else {
+        #pragma omp parallel
+        {
+            double local[QMC_MAX_SHIFTS] = {0.0};
+            #pragma omp for schedule(static)
+            for (long b = 0; b < nblocks; b++) {
+                long lo = begin + b * QMC_BLOCK;
+                int count = (int)(end - lo < QMC_BLOCK ? end - lo : QMC_BLOCK);
+                qmc_block_sums(cfg, &sh, fn, ctx, lo, count, local);
+            }
+            #pragma omp critical
+            {
+                for (int r = 0; r < shifts; r++) sums[r] += local[r];
+            }
+        }
+    }
+}
+
+// оценка и стандартная ошибка по суммам сдвигов
+static inline qmc_result_t qmc_finish(const qmc_config_t *cfg, const double *sums) {
+    qmc_result_t res;
+    double mean = 0.0;
+    for (int r = 0; r < cfg->shifts; r++) mean += sums[r] / cfg->points;
+    mean /= cfg->shifts;
+    double var = 0.0;
+    for (int r = 0; r < cfg->shifts; r++) {
+        double dev = sums[r] / cfg->points - mean;
+        var += dev * dev;
+    }
+    res.estimate = mean;
+    res.error = cfg->shifts > 1 ? sqrt(var / ((double)cfg->shifts * (cfg->shifts - 1))) : 0.0;
+    res.evaluations = cfg->points * cfg->shifts;
+    return res;
+}
+
+// интеграл по [0, 1]^dim на одном процессе
+static inline qmc_result_t qmc_integrate(const qmc_config_t *cfg, qmc_fn_t fn, void *ctx, qmc_mode_t mode) {
+    double sums[QMC_MAX_SHIFTS];
+    qmc_sums(cfg, fn, ctx, 0, cfg->points, mode, sums);
+    return qmc_finish(cfg, sums);
+}
+
+#ifdef MPI_VERSION
+// распределенный интеграл: процесс rank берет номера [N*rank/size, N*(rank+1)/size),
+// внутри процесса - редукция openmp; объединение вместе дает те же N точек
+static inline qmc_result_t qmc_integrate_mpi(const qmc_config_t *cfg, qmc_fn_t fn, void *ctx, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    long begin = cfg->points * rank / size;
+    long end = cfg->points * (rank + 1) / size;
+
+    double local[QMC_MAX_SHIFTS], sums[QMC_MAX_SHIFTS];
+    qmc_sums(cfg, fn, ctx, begin, end, QMC_REDUCTION, local);
+    MPI_Allreduce(local, sums, cfg->shifts, MPI_DOUBLE, MPI_SUM, comm);
+    return qmc_finish(cfg, sums);
+}
+#endif // MPI_VERSION
+
+#endif // QMC_H
@@ -0,0 +1,89 @@
+#ifndef ROMBERG_H
+#define ROMBERG_H
+
+// интегрирование по ромбергу: вложенные формулы трапеций и экстраполяция ричардсона
+//
+// при удвоении числа отрезков все старые узлы трапеций остаются узлами, а новые -
+// это середины старых отрезков, поэтому уровень k считается по уровню k-1 и
+// формуле средних прямоугольников на его сетке:
+//   T_k = (T_{k-1} + M_{k-1}) / 2,  M - метод средних прямоугольников с n_{k-1} отрезками
+// каждая точка вычисляется один раз: все уровни до 2^K отрезков стоят 2^K + 1
+// вычислений функции - столько же, сколько один самый мелкий уровень
+//
+// экстраполяция: R[k][j] = R[k][j-1] + (R[k][j-1] - R[k-1][j-1]) / (4^j - 1),
+// остановка, когда |R[k][k] - R[k-1][k-1]| <= max(abs_tol, rel_tol * |R[k][k]|)
+//
+// метод прямоугольников передается функцией midpoint(a, h, n, ctx), которая сама
+// распараллеливает свою сумму (например, редукцией openmp) - один вызов на уровень
+
+#include <math.h>
+
+#define ROMBERG_MAX_LEVELS 31  // 2^30 отрезков на последнем уровне
+
+// h * сумма f(a + (i + 0.5) * h) по i < n
+typedef double (*romberg_midpoint_fn_t)(double a, double h, long n, void *ctx);
+
+typedef struct {
+    double result;                 // R[k][k] последнего уровня
+    double error;                  // |R[k][k] - R[k-1][k-1]|
+    int levels;                    // построено уровней (k + 1)
+    long evaluations;              // вычислений функции (2^k + 1)
+    int converged;
+    double trapezoid[ROMBERG_MAX_LEVELS];  // T_k по уровням
+    double diagonal[ROMBERG_MAX_LEVELS];   // R[k][k] по уровням
+    double level_time[ROMBERG_MAX_LEVELS]; // время вычисления новых точек уровня (если задан clock)
+} romberg_result_t;
+
+// интеграл по [a, b]; fa_fb = f(a) + f(b), max_levels <= ROMBERG_MAX_LEVELS,
+// min_levels - сколько уровней построить до проверки сходимости (защита от
+// случайного совпадения на грубых сетках); clock - таймер для level_time или NULL
+static inline romberg_result_t romberg_integrate(romberg_midpoint_fn_t midpoint, void *ctx, double a, double b,
+                                                 double fa_fb, double abs_tol, double rel_tol,
+                                                 int min_levels, int max_levels, double (*clock)(void)) {
+    romberg_result_t r;
+    double prev_row[ROMBERG_MAX_LEVELS], row[ROMBERG_MAX_LEVELS];
+    if (max_levels > ROMBERG_MAX_LEVELS) max_levels = ROMBERG_MAX_LEVELS;
+
+    double h = b - a;
+    long n = 1;
+    prev_row[0] = 0.5 * h * fa_fb;
+    r.trapezoid[0] = prev_row[0];
+    r.diagonal[0] = prev_row[0];
+    r.level_time[0] = 0.0;
+    r.result = prev_row[0];
+    r.error = INFINITY;
+    r.levels = 1;
+    r.evaluations = 2;
+    r.converged = 0;
+
+    for (int k = 1; k < max_levels; k++) {
+        // новые узлы уровня k - середины n отрезков уровня k-1
+        double start = clock != NULL ? clock() : 0.0;
+        double m = midpoint(a, h, n, ctx);
+        r.level_time[k] = clock != NULL ? clock() - start : 0.0;
+        r.evaluations += n;
+        h *= 0.5;
+        n *= 2;
+
+        row[0] = 0.5 * (prev_row[0] + m);
+        double factor = 1.0;
+        for (int j = 1; j <= k; j++) {
+            factor *= 4.0;
+            row[j] = row[j - 1] + (row[j - 1] - prev_row[j - 1]) / (factor - 1.0);
+        }
+        r.trapezoid[k] = row[0];
+        r.diagonal[k] = row[k];
+        r.error = fabs(row[k] - prev_row[k - 1]);
+        r.result = row[k];
+        r.levels = k + 1;
+        for (int j = 0; j <= k; j++) prev_row[j] = row[j];
+
+        if (k + 1 >= min_levels && r.error <= fmax(abs_tol, rel_tol * fabs(row[k]))) {
+            r.converged = 1;
+            break;
+        }
+    }
+    return r;
+}
+
+#endif // ROMBERG_H
@@ -0,0 +1,243 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+// модель roofline: насколько ядро далеко от возможностей машины
+//
+// при первом обращении измеряются:
+// - пропускная способность памяти тестами stream copy (c = a) и triad (a = b + s*c)
+// - пиковая производительность fma (независимые цепочки fma во всех потоках)
+// ядро описывает себя числом байт и операций на элемент (roofline_kernel_t),
+// roofline_report по времени запуска печатает достигнутые ГБ/с и GFLOP/s
+// в процентах от потолка min(пик, интенсивность * triad)
+//
+// измерение и отчеты включаются только явным ROOFLINE=1: пробы занимают около секунды
+// и ~192 МБ памяти на запуск, поэтому по умолчанию не выполняются; ROOFLINE_STREAM_N задает длину
+// массивов stream (по умолчанию 8M double, 3 массива по 64 МБ - больше кэша)
+// без -fopenmp измеряется один поток (например, один процесс mpi)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_harness.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROOFLINE_X86 1
+#endif
+
+// директивы openmp только при -fopenmp (без предупреждений -Wunknown-pragmas в mpi-программах)
+#ifdef _OPENMP
+#define ROOFLINE_OMP(directive) _Pragma(directive)
+#else
+#define ROOFLINE_OMP(directive)
+#endif
+
+#define ROOFLINE_STREAM_N (1L << 23)
+#define ROOFLINE_REPS 5             // лучший из нескольких запусков, как в stream
+#define ROOFLINE_FMA_ITERS 4000000  // итераций пикового теста на поток
+#define ROOFLINE_FMA_CHAINS 12      // независимых цепочек: латентность fma x число портов
+
+typedef struct {
+    double copy_gbs;     // stream copy, ГБ/с (16 байт на элемент)
+    double triad_gbs;    // stream triad, ГБ/с (24 байта на элемент) - потолок памяти
+    double peak_gflops;  // пик fma, GFLOP/s - потолок вычислений
+    int threads;
+    const char *isa;     // набор инструкций пикового теста
+} roofline_t;
+
+// описание ядра: объем памяти и число операций на один обработанный элемент
+// (сравнения в min/max считаются операциями наравне с fma)
+typedef struct {
+    const char *name;
+    double bytes_per_elem;
+    double flops_per_elem;
+    int flops_partial;   // 1 - часть операций не учтена (вызов функции): печатаются
+                         // только ГБ/с и GFLOP/s, без доли потолка
+} roofline_kernel_t;
+
+// ROOFLINE=1 (любое непустое значение, кроме 0) - измерять потолки и печатать отчеты
+static inline int roofline_enabled(void) {
+    const char *env = getenv("ROOFLINE");
+    return env != NULL && *env != '\0' && strcmp(env, "0") != 0;
+}
+
+// пиковые тесты: каждая итерация - ROOFLINE_FMA_CHAINS независимых fma,
+// значения сходятся к 1 и не уходят в денормализованные числа
+
+static inline double roofline_fma_scalar(long iters, double *flops) {
+    double acc[ROOFLINE_FMA_CHAINS];
+    for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = k * 0.01;
+    for (long it = 0; it < iters; it++) {
+        for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = acc[k] * 0.999999 + 1e-6;
+    }
+    *flops = 2.0 * ROOFLINE_FMA_CHAINS * iters;
+    double s = 0.0;
+    for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) s += acc[k];
+    return s;
+}
+
+#ifdef ROOFLINE_X86
+
+__attribute__((target("avx2,fma")))
+static inline double roofline_fma_avx2(long iters, double *flops) {
+    __m256d acc[ROOFLINE_FMA_CHAINS];
+    const __m256d m = _mm256_set1_pd(0.999999), c = _mm256_set1_pd(1e-6);
+    for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = _mm256_set1_pd(k * 0.01);
+    for (long it = 0; it < iters; it++) {
+        for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = _mm256_fmadd_pd(acc[k], m, c);
+    }
+    *flops = 2.0 * 4 * ROOFLINE_FMA_CHAINS * iters;
+    __m256d s = acc[0];
+    for (int k = 1; k < ROOFLINE_FMA_CHAINS; k++) s = _mm256_add_pd(s, acc[k]);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, s);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx512f")))
+static inline double roofline_fma_avx512(long iters, double *flops) {
+    __m512d acc[ROOFLINE_FMA_CHAINS];
+    const __m512d m = _mm512_set1_pd(0.999999), c = _mm512_set1_pd(1e-6);
+    for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = _mm512_set1_pd(k * 0.01);
+    for (long it = 0; it < iters; it++) {
+        for (int k = 0; k < ROOFLINE_FMA_CHAINS; k++) acc[k] = _mm512_fmadd_pd(acc[k], m, c);
+    }
+    *flops = 2.0 * 8 * ROOFLINE_FMA_CHAINS * iters;
+    __m512d s = acc[0];
+    for (int k = 1; k < ROOFLINE_FMA_CHAINS; k++) s = _mm512_add_pd(s, acc[k]);
+    return _mm512_reduce_add_pd(s);
+}
+
+#endif // ROOFLINE_X86
+
+typedef double (*roofline_fma_fn_t)(long iters, double *flops);
+
+static inline roofline_fma_fn_t roofline_select_fma(const char **isa) {
+    *isa = "scalar";
+#ifdef ROOFLINE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) { *isa = "avx512"; return roofline_fma_avx512; }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        *isa = "avx2+fma";
+        return roofline_fma_avx2;
+    }
+#endif
+    return roofline_fma_scalar;
+}
+
+// измерение потолков (без кэширования)
+static inline roofline_t roofline_measure(void) {
+    roofline_t m;
+    memset(&m, 0, sizeof(m));
+    m.threads = bench_threads();
+
+    long n = ROOFLINE_STREAM_N;
+    const char *env = getenv("ROOFLINE_STREAM_N");
+    if (env != NULL && atol(env) > 0) n = atol(env);
+
+    double *a = (double *)malloc(n * sizeof(double));
+    double *b = (double *)malloc(n * sizeof(double));
+    double *c = (double *)malloc(n * sizeof(double));
+    if (a != NULL && b != NULL && c != NULL) {
+        // первое касание тем же schedule(static), что и в тестах
+        ROOFLINE_OMP("omp parallel for schedule(static)")
+        for (long i = 0; i < n; i++) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.5;
+        }
+        double best_copy = 1e30, best_triad = 1e30;
+        for (int r = 0; r < ROOFLINE_REPS; r++) {
+            double t0 = bench_now();
+            ROOFLINE_OMP("omp parallel for schedule(static)")
+            for (long i = 0; i < n; i++) c[i] = a[i];
+            double t1 = bench_now();
+            ROOFLINE_OMP("omp parallel for schedule(static)")
+            for (long i = 0; i < n; i++) a[i] = b[i] + 3.0 * c[i];
+            double t2 = bench_now();
+            if (t1 - t0 < best_copy) best_copy = t1 - t0;
+            if (t2 - t1 < best_triad) best_triad = t2 - t1;
+        }
+        m.copy_gbs = 16.0 * n / best_copy / 1e9;
+        m.triad_gbs = 24.0 * n / best_triad / 1e9;
+    }
+    free(a);
+    free(b);
+    free(c);
+
+    roofline_fma_fn_t fma = roofline_select_fma(&m.isa);
+    double best_fma = 1e30, flops = 0.0, sink = 0.0;
+    for (int r = 0; r < 3; r++) {
+        double total_flops = 0.0;
+        double t0 = bench_now();
+        ROOFLINE_OMP("omp parallel reduction(+:total_flops, sink)")
+        {
+            double f;
+            sink += fma(ROOFLINE_FMA_ITERS, &f);
+            total_flops += f;
+        }
+        double t = bench_now() - t0;
+        if (t < best_fma) {
+            best_fma = t;
+            flops = total_flops;
+        }
+    }
+    volatile double keep = sink;  // результат используется - цикл не выбрасывается
+    (void)keep;
+    m.peak_gflops = flops / best_fma / 1e9;
+    return m;
+}
+
+static roofline_t roofline_cached;
+static int roofline_cached_valid = 0;
+
+// потолки машины (измеряются один раз за запуск)
+static inline const roofline_t *roofline_get(void) {
+    if (!roofline_cached_valid) {
+        roofline_cached = roofline_measure();
+        roofline_cached_valid = 1;
+    }
+    return &roofline_cached;
+}
+
+static inline void roofline_print_machine(const roofline_t *m) {
+    printf("roofline (%d потоков): stream copy %.2f ГБ/с, triad %.2f ГБ/с, пик fma (%s) %.2f GFLOP/s\n",
+           m->threads, m->copy_gbs, m->triad_gbs, m->isa, m->peak_gflops);
+}
+
+// отчет ядра относительно заданных потолков
+static inline void roofline_report_with(const roofline_t *m, const roofline_kernel_t *k,
+                                        double elements, double seconds) {
+    if (seconds <= 0.0) return;
+    double gbs = k->bytes_per_elem * elements / seconds / 1e9;
+    double gflops = k->flops_per_elem * elements / seconds / 1e9;
+    double pct_bw = m->triad_gbs > 0.0 ? 100.0 * gbs / m->triad_gbs : 0.0;
+    double pct_peak = m->peak_gflops > 0.0 ? 100.0 * gflops / m->peak_gflops : 0.0;
+
+    // потолок для интенсивности ядра и что его ограничивает
+    double ai = k->bytes_per_elem > 0.0 ? k->flops_per_elem / k->bytes_per_elem : 1e30;
+    double mem_roof = ai * m->triad_gbs;
+    int memory_bound = mem_roof < m->peak_gflops;
+    double roof = memory_bound ? mem_roof : m->peak_gflops;
+    double attained = roof > 0.0 ? 100.0 * gflops / roof : 0.0;
+    if (k->flops_per_elem == 0.0) attained = pct_bw;
+
+    printf("  roofline (%s): ", k->name);
+    if (k->bytes_per_elem > 0.0) printf("%.2f ГБ/с (%.0f%% от triad), ", gbs, pct_bw);
+    if (k->flops_partial) {
+        printf("%.2f GFLOP/s учтенных операций (%.0f%% от пика)\n", gflops, pct_peak);
+        return;
+    }
+    printf("%.2f GFLOP/s (%.0f%% от пика), ", gflops, pct_peak);
+    if (k->bytes_per_elem > 0.0) printf("интенсивность %.3f флоп/байт, ", ai);
+    printf("ограничение: %s, достигнуто %.0f%% потолка\n",
+           memory_bound ? "память" : "вычисления", attained);
+}
+
+// отчет ядра относительно потолков этой машины
+static inline void roofline_report(const roofline_kernel_t *k, double elements, double seconds) {
+    if (!roofline_enabled()) return;
+    roofline_report_with(roofline_get(), k, elements, seconds);
+}
+
+#endif // ROOFLINE_H
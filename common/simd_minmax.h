@@ -0,0 +1,178 @@
+#ifndef SIMD_MINMAX_H
+#define SIMD_MINMAX_H
+
+// векторизованный поиск минимума и максимума в массиве double
+// реализация выбирается один раз во время выполнения по cpuid:
+// avx-512 -> avx2 -> sse2 -> скалярная версия
+// в каждой версии несколько независимых аккумуляторов, чтобы разорвать
+// цепочку зависимостей между соседними сравнениями
+
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_MINMAX_X86 1
+#endif
+
+typedef void (*minmax_kernel_t)(const double *arr, long n, double *out_min, double *out_max);
+
+// скалярная версия с 4 аккумуляторами (без ветвлений - компилятор превращает ?: в minsd/maxsd)
+static inline void minmax_scalar(const double *arr, long n, double *out_min, double *out_max) {
+    if (n <= 0) return;
+    double mn0 = arr[0], mn1 = arr[0], mn2 = arr[0], mn3 = arr[0];
+    double mx0 = arr[0], mx1 = arr[0], mx2 = arr[0], mx3 = arr[0];
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        mn0 = arr[i]     < mn0 ? arr[i]     : mn0;  mx0 = arr[i]     > mx0 ? arr[i]     : mx0;
+        mn1 = arr[i + 1] < mn1 ? arr[i + 1] : mn1;  mx1 = arr[i + 1] > mx1 ? arr[i + 1] : mx1;
+        mn2 = arr[i + 2] < mn2 ? arr[i + 2] : mn2;  mx2 = arr[i + 2] > mx2 ? arr[i + 2] : mx2;
+        mn3 = arr[i + 3] < mn3 ? arr[i + 3] : mn3;  mx3 = arr[i + 3] > mx3 ? arr[i + 3] : mx3;
+    }
+    for (; i < n; i++) {
+        mn0 = arr[i] < mn0 ? arr[i] : mn0;
+        mx0 = arr[i] > mx0 ? arr[i] : mx0;
+    }
+    mn0 = mn1 < mn0 ? mn1 : mn0;  mn2 = mn3 < mn2 ? mn3 : mn2;
+    mx0 = mx1 > mx0 ? mx1 : mx0;  mx2 = mx3 > mx2 ? mx3 : mx2;
+    *out_min = mn2 < mn0 ? mn2 : mn0;
+    *out_max = mx2 > mx0 ? mx2 : mx0;
+}
+
+#ifdef SIMD_MINMAX_X86
+
+// sse2: 4 регистра по 2 double = 8 элементов за итерацию
+__attribute__((target("sse2")))
+static inline void minmax_sse2(const double *arr, long n, double *out_min, double *out_max) {
+    if (n < 8) { minmax_scalar(arr, n, out_min, out_max); return; }
+    __m128d mn0 = _mm_set1_pd(arr[0]), mn1 = mn0, mn2 = mn0, mn3 = mn0;
+    __m128d mx0 = mn0, mx1 = mn0, mx2 = mn0, mx3 = mn0;
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128d v0 = _mm_loadu_pd(arr + i);
+        __m128d v1 = _mm_loadu_pd(arr + i + 2);
+        __m128d v2 = _mm_loadu_pd(arr + i + 4);
+        __m128d v3 = _mm_loadu_pd(arr + i + 6);
+        mn0 = _mm_min_pd(mn0, v0);  mx0 = _mm_max_pd(mx0, v0);
+        mn1 = _mm_min_pd(mn1, v1);  mx1 = _mm_max_pd(mx1, v1);
+        mn2 = _mm_min_pd(mn2, v2);  mx2 = _mm_max_pd(mx2, v2);
+        mn3 = _mm_min_pd(mn3, v3);  mx3 = _mm_max_pd(mx3, v3);
+    }
+    mn0 = _mm_min_pd(_mm_min_pd(mn0, mn1), _mm_min_pd(mn2, mn3));
+    mx0 = _mm_max_pd(_mm_max_pd(mx0, mx1), _mm_max_pd(mx2, mx3));
+    double lo[2], hi[2];
+    _mm_storeu_pd(lo, mn0);
+    _mm_storeu_pd(hi, mx0);
+    double mn = lo[0] < lo[1] ? lo[0] : lo[1];
+    double mx = hi[0] > hi[1] ? hi[0] : hi[1];
+    for (; i < n; i++) {  // хвост массива
+        mn = arr[i] < mn ? arr[i] : mn;
+        mx = arr[i] > mx ? arr[i] : mx;
+    }
+    *out_min = mn;
+    *out_max = mx;
+}
+
+// avx2: 4 регистра по 4 double = 16 элементов за итерацию
+__attribute__((target("avx2")))
+static inline void minmax_avx2(const double *arr, long n, double *out_min, double *out_max) {
+    if (n < 16) { minmax_scalar(arr, n, out_min, out_max); return; }
+    __m256d mn0 = _mm256_set1_pd(arr[0]), mn1 = mn0, mn2 = mn0, mn3 = mn0;
+    __m256d mx0 = mn0, mx1 = mn0, mx2 = mn0, mx3 = mn0;
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256d v0 = _mm256_loadu_pd(arr + i);
+        __m256d v1 = _mm256_loadu_pd(arr + i + 4);
+        __m256d v2 = _mm256_loadu_pd(arr + i + 8);
+        __m256d v3 = _mm256_loadu_pd(arr + i + 12);
+        mn0 = _mm256_min_pd(mn0, v0);  mx0 = _mm256_max_pd(mx0, v0);
+        mn1 = _mm256_min_pd(mn1, v1);  mx1 = _mm256_max_pd(mx1, v1);
+        mn2 = _mm256_min_pd(mn2, v2);  mx2 = _mm256_max_pd(mx2, v2);
+        mn3 = _mm256_min_pd(mn3, v3);  mx3 = _mm256_max_pd(mx3, v3);
+    }
+    mn0 = _mm256_min_pd(_mm256_min_pd(mn0, mn1), _mm256_min_pd(mn2, mn3));
+    mx0 = _mm256_max_pd(_mm256_max_pd(mx0, mx1), _mm256_max_pd(mx2, mx3));
+    double lo[4], hi[4];
+    _mm256_storeu_pd(lo, mn0);
+    _mm256_storeu_pd(hi, mx0);
+    double mn = lo[0], mx = hi[0];
+    for (int k = 1; k < 4; k++) {
+        mn = lo[k] < mn ? lo[k] : mn;
+        mx = hi[k] > mx ? hi[k] : mx;
+    }
+    for (; i < n; i++) {
+        mn = arr[i] < mn ? arr[i] : mn;
+        mx = arr[i] > mx ? arr[i] : mx;
+    }
+    *out_min = mn;
+    *out_max = mx;
+}
+
+// avx-512: 4 регистра по 8 double = 32 элемента за итерацию, хвост через маску
+__attribute__((target("avx512f")))
+static inline void minmax_avx512(const double *arr, long n, double *out_min, double *out_max) {
+    if (n < 32) { minmax_scalar(arr, n, out_min, out_max); return; }
+    __m512d mn0 = _mm512_set1_pd(arr[0]), mn1 = mn0, mn2 = mn0, mn3 = mn0;
+    __m512d mx0 = mn0, mx1 = mn0, mx2 = mn0, mx3 = mn0;
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512d v0 = _mm512_loadu_pd(arr + i);
+        __m512d v1 = _mm512_loadu_pd(arr + i + 8);
+        __m512d v2 = _mm512_loadu_pd(arr + i + 16);
+        __m512d v3 = _mm512_loadu_pd(arr + i + 24);
+        mn0 = _mm512_min_pd(mn0, v0);  mx0 = _mm512_max_pd(mx0, v0);
+        mn1 = _mm512_min_pd(mn1, v1);  mx1 = _mm512_max_pd(mx1, v1);
+        mn2 = _mm512_min_pd(mn2, v2);  mx2 = _mm512_max_pd(mx2, v2);
+        mn3 = _mm512_min_pd(mn3, v3);  mx3 = _mm512_max_pd(mx3, v3);
+    }
+    for (; i < n; i += 8) {
+        // неполные блоки: незагруженные элементы берутся из текущих mn0 (для минимума)
+        // и mx0 (для максимума), поэтому ответ не меняется
+        __mmask8 m = (n - i >= 8) ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d v = _mm512_mask_loadu_pd(mn0, m, arr + i);
+        __m512d w = _mm512_mask_loadu_pd(mx0, m, arr + i);
+        mn0 = _mm512_min_pd(mn0, v);
+        mx0 = _mm512_max_pd(mx0, w);
+    }
+    mn0 = _mm512_min_pd(_mm512_min_pd(mn0, mn1), _mm512_min_pd(mn2, mn3));
+    mx0 = _mm512_max_pd(_mm512_max_pd(mx0, mx1), _mm512_max_pd(mx2, mx3));
+    *out_min = _mm512_reduce_min_pd(mn0);
+    *out_max = _mm512_reduce_max_pd(mx0);
+}
+
+#endif // SIMD_MINMAX_X86
+
+static minmax_kernel_t minmax_selected_kernel = NULL;
+static const char *minmax_selected_name = "scalar";
+
+// выбор лучшей доступной реализации (вызывается один раз, дальше берется из кэша)
+static inline minmax_kernel_t minmax_select_kernel(void) {
+    if (minmax_selected_kernel != NULL) return minmax_selected_kernel;
+    minmax_kernel_t kernel = minmax_scalar;
+    const char *name = "scalar";
+#ifdef SIMD_MINMAX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        kernel = minmax_avx512; name = "avx512";
+    } else if (__builtin_cpu_supports("avx2")) {
+        kernel = minmax_avx2; name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernel = minmax_sse2; name = "sse2";
+    }
+#endif
+    minmax_selected_name = name;
+    minmax_selected_kernel = kernel;
+    return kernel;
+}
+
+// название выбранного набора инструкций (для отчета)
+static inline const char *minmax_kernel_name(void) {
+    minmax_select_kernel();
+    return minmax_selected_name;
+}
+
+// основная точка входа: min/max массива через лучший доступный kernel
+static inline void minmax_simd(const double *arr, long n, double *out_min, double *out_max) {
+    minmax_select_kernel()(arr, n, out_min, out_max);
+}
+
+#endif // SIMD_MINMAX_H
@@ -0,0 +1,227 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+// планировщик циклов с кражей работы (work stealing)
+//
+// schedule(dynamic) раздает порции через один общий счетчик: каждая порция - атомарная
+// операция над одной кэш-линией, и при десятках потоков она становится узким местом.
+// здесь у каждого потока своя двусторонняя очередь chase-lev:
+// - поток получает свой блок итераций как в schedule(static) и кладет его в очередь
+// - владелец берет диапазон снизу и делит его пополам, пока он больше grain:
+//   верхняя половина кладется в очередь, нижняя делится дальше (ленивое деление)
+// - поток с пустой очередью крадет сверху очереди случайного потока - сверху лежат
+//   самые большие куски, поэтому краж мало
+// владелец работает со своей очередью без атомарных операций чтение-запись, кроме
+// последнего элемента; общий счетчик оставшихся итераций меняется только когда очередь
+// потока опустела (один раз на украденный кусок, а не на порцию)
+//
+// очередь - по Lê, Pop, Cohen, Zappa Nardelli, "Correct and efficient work-stealing
+// for weak memory models" (PPoPP 2013), на атомарных операциях c11. элемент очереди -
+// диапазон [lo, hi) смещений от начала цикла, упакованный в 64 бита (по 32 бита),
+// поэтому один запуск делится на куски не длиннее 2^32 - 1 итераций
+//
+// ws_parallel_for(begin, end, grain, body, ctx, stats) вызывает body(lo, hi, ctx)
+// для непересекающихся диапазонов, покрывающих [begin, end), изнутри параллельной
+// области openmp (omp_get_thread_num() в body - номер потока); вызывается вне ее.
+// если очереди не удалось выделить, работа раздается обычным omp for (краж в stats нет)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <omp.h>
+
+#define WS_DEQUE_CAPACITY 128          // глубина ленивого деления <= 64 уровней
+#define WS_MAX_SPAN 0xFFFFFFFFL        // итераций в одном запуске планировщика
+#define WS_EMPTY UINT64_MAX            // очередь пуста
+#define WS_ABORT (UINT64_MAX - 1)      // кража проиграла гонку - можно повторить
+
+typedef void (*ws_body_t)(long begin, long end, void *ctx);
+
+// счетчики потока за один ws_parallel_for
+typedef struct {
+    long iterations;     // выполнено итераций
+    long chunks;         // вызовов body
+    long steals;         // удачных краж
+    long failed_steals;  // попыток кражи из пустой очереди или проигранных гонок
+    char pad[64 - 4 * sizeof(long)];
+} ws_stats_t;
+
+typedef struct {
+    _Atomic long top;
+    char pad_top[64 - sizeof(long)];   // top меняют воры, bottom - владелец
+    _Atomic long bottom;
+    char pad_bottom[64 - sizeof(long)];
+    _Atomic uint64_t buffer[WS_DEQUE_CAPACITY];
+} ws_deque_t;
+
+static inline uint64_t ws_pack(long lo, long hi) {
+    return ((uint64_t)lo << 32) | (uint64_t)hi;
+}
+
+static inline void ws_push(ws_deque_t *q, uint64_t x) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    atomic_store_explicit(&q->buffer[b % WS_DEQUE_CAPACITY], x, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+}
+
+// взять снизу (только владелец)
+static inline uint64_t ws_take(ws_deque_t *q) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&q->top, memory_order_relaxed);
+    uint64_t x = WS_EMPTY;
+    if (t <= b) {
+        x = atomic_load_explicit(&q->buffer[b % WS_DEQUE_CAPACITY], memory_order_relaxed);
+        if (t == b) {
+            // последний элемент - соревнуемся с ворами за top
+            if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                x = WS_EMPTY;
+            }
+            atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+// украсть сверху (любой поток)
+static inline uint64_t ws_steal(ws_deque_t *q) {
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+    if (t >= b) return WS_EMPTY;
+    uint64_t x = atomic_load_explicit(&q->buffer[t % WS_DEQUE_CAPACITY], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return WS_ABORT;
+    }
+    return x;
+}
+
+static inline uint64_t ws_xorshift(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// запасной вариант без очередей: обычный omp for по кускам из grain итераций
+// (schedule(dynamic) - тот же общий счетчик, от которого уходит планировщик)
+static inline void ws_run_plain(long begin, long span, long grain, ws_body_t body, void *ctx,
+                                ws_stats_t *stats) {
+    long chunks = (span + grain - 1) / grain;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long c = 0; c < chunks; c++) {
+        long lo = c * grain, hi = lo + grain < span ? lo + grain : span;
+        body(begin + lo, begin + hi, ctx);
+        if (stats != NULL) {
+            int tid = omp_get_thread_num();
+            stats[tid].iterations += hi - lo;
+            stats[tid].chunks++;
+        }
+    }
+}
+
+// один запуск для span <= WS_MAX_SPAN итераций
+static inline void ws_run_span(long begin, long span, long grain, ws_body_t body, void *ctx,
+                               ws_stats_t *stats) {
+    int max_threads = omp_get_max_threads();
+    ws_deque_t *deques = (ws_deque_t *)aligned_alloc(64, max_threads * sizeof(ws_deque_t));
+    if (deques == NULL) {  // без памяти под очереди - без кражи работы
+        ws_run_plain(begin, span, grain, body, ctx, stats);
+        return;
+    }
+    memset(deques, 0, max_threads * sizeof(ws_deque_t));
+    _Atomic long remaining = span;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        ws_deque_t *mine = &deques[tid];
+        ws_stats_t local;
+        memset(&local, 0, sizeof(local));
+        uint64_t rng = 0x9E3779B97F4A7C15ULL * (tid + 1);
+        long done = 0;  // выполнено с последнего обновления remaining
+
+        // начальный блок как в schedule(static)
+        long lo0 = span * tid / nthreads, hi0 = span * (tid + 1) / nthreads;
+        if (hi0 > lo0) ws_push(mine, ws_pack(lo0, hi0));
+
+        for (;;) {
+            uint64_t r = ws_take(mine);
+            if (r == WS_EMPTY) {
+                if (done > 0) {
+                    atomic_fetch_sub_explicit(&remaining, done, memory_order_acq_rel);
+                    done = 0;
+                }
+                int misses = 0;
+                while (atomic_load_explicit(&remaining, memory_order_acquire) > 0) {
+                    if (nthreads == 1) break;
+                    int victim = (int)(ws_xorshift(&rng) % (uint64_t)(nthreads - 1));
+                    if (victim >= tid) victim++;
+                    r = ws_steal(&deques[victim]);
+                    if (r != WS_EMPTY && r != WS_ABORT) {
+                        local.steals++;
+                        break;
+                    }
+                    local.failed_steals++;
+                    // круг неудач - уступаем ядро (потоков может быть больше, чем ядер)
+                    if (++misses % nthreads == 0) sched_yield();
+                }
+                if (r == WS_EMPTY || r == WS_ABORT) break;  // вся работа выполнена
+            }
+
+            long lo = (long)(r >> 32), hi = (long)(r & 0xFFFFFFFFULL);
+            while (hi - lo > grain) {
+                long mid = lo + (hi - lo) / 2;
+                ws_push(mine, ws_pack(mid, hi));
+                hi = mid;
+            }
+            body(begin + lo, begin + hi, ctx);
+            local.chunks++;
+            local.iterations += hi - lo;
+            done += hi - lo;
+        }
+
+        if (stats != NULL) {
+            stats[tid].iterations += local.iterations;
+            stats[tid].chunks += local.chunks;
+            stats[tid].steals += local.steals;
+            stats[tid].failed_steals += local.failed_steals;
+        }
+    }
+    free(deques);
+}
+
+// stats - массив из omp_get_max_threads() счетчиков (обнуляется) или NULL
+static inline void ws_parallel_for(long begin, long end, long grain, ws_body_t body, void *ctx,
+                                   ws_stats_t *stats) {
+    if (grain < 1) grain = 1;
+    if (stats != NULL) memset(stats, 0, omp_get_max_threads() * sizeof(ws_stats_t));
+    for (long lo = begin; lo < end; lo += WS_MAX_SPAN) {
+        long span = end - lo < WS_MAX_SPAN ? end - lo : WS_MAX_SPAN;
+        ws_run_span(lo, span, grain, body, ctx, stats);
+    }
+}
+
+// сумма счетчиков по потокам
+static inline ws_stats_t ws_stats_total(const ws_stats_t *stats, int threads) {
+    ws_stats_t total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < threads; t++) {
+        total.iterations += stats[t].iterations;
+        total.chunks += stats[t].chunks;
+        total.steals += stats[t].steals;
+        total.failed_steals += stats[t].failed_steals;
+    }
+    return total;
+}
+
+#endif // WORK_STEALING_H
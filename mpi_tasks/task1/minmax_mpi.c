@@ -3,6 +3,7 @@
 #include <mpi.h>     
 #include <time.h>
 #include <limits.h>
+#include "../../common/fused_stats.h"
 
 // Генерация случайной части вектора
 void generate_vector_part(double *vector, int size, int seed_offset) {
@@ -12,14 +13,10 @@ void generate_vector_part(double *vector, int size, int seed_offset) {
     }
 }
 
-void find_local_min_max(double *vector, int local_size, double *local_min, double *local_max) {
-    *local_min = vector[0];
-    *local_max = vector[0];
-    
-    for (int i = 1; i < local_size; i++) {
-        if (vector[i] < *local_min) *local_min = vector[i];
-        if (vector[i] > *local_max) *local_max = vector[i];
-    }
+// Локальная статистика за один проход: min/max с индексами, среднее, дисперсия
+// global_offset - индекс первого локального элемента в полном векторе
+array_stats_t find_local_stats(double *vector, int local_size, long global_offset) {
+    return stats_compute(vector, local_size, global_offset);
 }
 
 void run_parallel_experiment(int vector_size, int use_processes, int world_rank, int world_size) {
@@ -36,6 +33,12 @@ void run_parallel_experiment(int vector_size, int use_processes, int world_rank,
         int local_size = vector_size / size;
         int remainder = vector_size % size;
         if (rank < remainder) local_size++;
+        long global_offset = (long)rank * (vector_size / size) + (rank < remainder ? rank : remainder);
+        
+        // Тип и операция MPI для объединения статистик
+        MPI_Datatype stats_type;
+        MPI_Op stats_op;
+        stats_mpi_create(&stats_type, &stats_op);
         
         // Синхронизируем и замеряем время
         MPI_Barrier(comm);
@@ -51,14 +54,12 @@ void run_parallel_experiment(int vector_size, int use_processes, int world_rank,
         
         generate_vector_part(local_vector, local_size, rank);
         
-        // Находим локальные минимум/максимум
-        double local_min, local_max;
-        find_local_min_max(local_vector, local_size, &local_min, &local_max);
+        // Находим локальную статистику за один проход
+        array_stats_t local_stats = find_local_stats(local_vector, local_size, global_offset);
         
-        // Собираем результаты
-        double global_min, global_max;
-        MPI_Reduce(&local_min, &global_min, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
-        MPI_Reduce(&local_max, &global_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        // Собираем результаты одним MPI_Reduce с пользовательской операцией
+        array_stats_t global_stats;
+        MPI_Reduce(&local_stats, &global_stats, 1, stats_type, stats_op, 0, comm);
         
         double end_time = MPI_Wtime();
         double elapsed_time = end_time - start_time;
@@ -70,9 +71,12 @@ void run_parallel_experiment(int vector_size, int use_processes, int world_rank,
         if (rank == 0) {
             printf("PARALLEL: processes=%2d, vector_size=%-12d, time=%9.6f sec\n", 
                    size, vector_size, max_time);
-            // printf("  min=%.2f, max=%.2f\n", global_min, global_max);
+            printf("  min=%.2f [%ld], max=%.2f [%ld], mean=%.4f, var=%.4f\n",
+                   global_stats.min, global_stats.argmin, global_stats.max, global_stats.argmax,
+                   global_stats.mean, stats_variance(global_stats, 0));
         }
         
+        stats_mpi_free(&stats_type, &stats_op);
         free(local_vector);
         MPI_Comm_free(&comm);
     }
@@ -104,19 +108,16 @@ void run_sequential_experiment(int vector_size, int world_rank) {
                 vector[i] = (double)rand() / RAND_MAX * 1000.0;
             }
             
-            // Поиск min/max
-            double min_val = vector[0];
-            double max_val = vector[0];
-            for (int i = 1; i < size; i++) {
-                if (vector[i] < min_val) min_val = vector[i];
-                if (vector[i] > max_val) max_val = vector[i];
-            }
+            // Поиск min/max и остальной статистики за один проход
+            array_stats_t stats = stats_compute(vector, size, 0);
             
             double end_time = MPI_Wtime();
             
             printf("SEQUENTIAL: processes= 1, vector_size=%-12d, time=%9.6f sec\n", 
                    size, end_time - start_time);
-            // printf("  min=%.2f, max=%.2f\n", min_val, max_val);
+            printf("  min=%.2f [%ld], max=%.2f [%ld], mean=%.4f, var=%.4f\n",
+                   stats.min, stats.argmin, stats.max, stats.argmax,
+                   stats.mean, stats_variance(stats, 0));
             
             free(vector);
         }
@@ -4,6 +4,56 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include "../../common/bench_harness.h"
+
+// данные для замеров коллективных операций на разных коммуникаторах
+typedef struct {
+    double* data;
+    double* result;
+    int data_size;
+    int num_iterations;
+    int row_rank;
+    MPI_Comm row_comm;
+    MPI_Comm col_comm;
+} grid_ctx_t;
+
+// тест 1: Broadcast на всем коммуникаторе WORLD (все процессы)
+void world_bcast(void* arg) {
+    grid_ctx_t* ctx = (grid_ctx_t*)arg;
+    for (int iter = 0; iter < ctx->num_iterations; iter++) {
+        MPI_Bcast(ctx->data, ctx->data_size, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+}
+
+// тест 2: Broadcast на коммуникаторе строки (только процессы одной строки)
+void row_bcast(void* arg) {
+    grid_ctx_t* ctx = (grid_ctx_t*)arg;
+    for (int iter = 0; iter < ctx->num_iterations; iter++) {
+        // в каждой строке процесс с row_rank == 0 является корнем для broadcast
+        if (ctx->row_rank == 0) {
+            MPI_Bcast(ctx->data, ctx->data_size, MPI_DOUBLE, 0, ctx->row_comm);
+        } else {
+            MPI_Bcast(ctx->result, ctx->data_size, MPI_DOUBLE, 0, ctx->row_comm);
+        }
+    }
+}
+
+// тест 3: Reduce на всем коммуникаторе WORLD (все процессы)
+void world_reduce(void* arg) {
+    grid_ctx_t* ctx = (grid_ctx_t*)arg;
+    for (int iter = 0; iter < ctx->num_iterations; iter++) {
+        MPI_Reduce(ctx->data, ctx->result, ctx->data_size, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
+}
+
+// тест 4: Reduce на коммуникаторе столбца (только процессы одного столбца)
+void col_reduce(void* arg) {
+    grid_ctx_t* ctx = (grid_ctx_t*)arg;
+    for (int iter = 0; iter < ctx->num_iterations; iter++) {
+        // в каждом столбце процесс с col_rank == 0 является корнем для reduce
+        MPI_Reduce(ctx->data, ctx->result, ctx->data_size, MPI_DOUBLE, MPI_SUM, 0, ctx->col_comm);
+    }
+}
 
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
@@ -84,55 +134,22 @@ int main(int argc, char** argv) {
         printf("Data size: %d doubles, Iterations: %d\n", DATA_SIZE, NUM_ITERATIONS);
     }
     
-    // тест 1: Broadcast на всем коммуникаторе WORLD (все процессы)
-    MPI_Barrier(MPI_COMM_WORLD);
-    double world_start = MPI_Wtime();
+    // каждый тест повторяется BENCH_REPS раз (по умолчанию 2 прогревочных, 10 измеряемых),
+    // в одном повторении NUM_ITERATIONS вызовов; время повторения - максимум по процессам
+    bench_config_t cfg = bench_config_from_env(2, 10);
+    grid_ctx_t ctx = {data, result, DATA_SIZE, NUM_ITERATIONS, row_rank, row_comm, col_comm};
+    bench_result_t results[4];
     
-    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
-        MPI_Bcast(data, DATA_SIZE, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    }
-    
-    double world_end = MPI_Wtime();
-    double world_time = world_end - world_start;
-    
-    // тест 2: Broadcast на коммуникаторе строки (только процессы одной строки)
-    MPI_Barrier(MPI_COMM_WORLD);
-    double row_start = MPI_Wtime();
-    
-    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
-        // в каждой строке процесс с row_rank == 0 является корнем для broadcast
-        if (row_rank == 0) {
-            MPI_Bcast(data, DATA_SIZE, MPI_DOUBLE, 0, row_comm);
-        } else {
-            MPI_Bcast(result, DATA_SIZE, MPI_DOUBLE, 0, row_comm);
-        }
-    }
+    bench_run_mpi("world_bcast", world_bcast, &ctx, cfg, MPI_COMM_WORLD, &results[0]);
+    bench_run_mpi("row_bcast", row_bcast, &ctx, cfg, MPI_COMM_WORLD, &results[1]);
+    bench_run_mpi("world_reduce", world_reduce, &ctx, cfg, MPI_COMM_WORLD, &results[2]);
+    bench_run_mpi("col_reduce", col_reduce, &ctx, cfg, MPI_COMM_WORLD, &results[3]);
     
-    double row_end = MPI_Wtime();
-    double row_time = row_end - row_start;
-    
-    // тест 3: Reduce на всем коммуникаторе WORLD (все процессы)
-    MPI_Barrier(MPI_COMM_WORLD);
-    double world_reduce_start = MPI_Wtime();
-    
-    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
-        MPI_Reduce(data, result, DATA_SIZE, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-    }
-    
-    double world_reduce_end = MPI_Wtime();
-    double world_reduce_time = world_reduce_end - world_reduce_start;
-    
-    // тест 4: Reduce на коммуникаторе столбца (только процессы одного столбца)
-    MPI_Barrier(MPI_COMM_WORLD);
-    double col_reduce_start = MPI_Wtime();
-    
-    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
-        // в каждом столбце процесс с col_rank == 0 является корнем для reduce
-        MPI_Reduce(data, result, DATA_SIZE, MPI_DOUBLE, MPI_SUM, 0, col_comm);
-    }
-    
-    double col_reduce_end = MPI_Wtime();
-    double col_reduce_time = col_reduce_end - col_reduce_start;
+    // медианы по повторениям
+    double world_time = results[0].median;
+    double row_time = results[1].median;
+    double world_reduce_time = results[2].median;
+    double col_reduce_time = results[3].median;
     
     // сбор и вывод результатов на процессе 0
     if (world_rank == 0) {
@@ -145,15 +162,17 @@ int main(int argc, char** argv) {
         printf("COL Reduce:     %.6f seconds\n", col_reduce_time);
         printf("Ratio (WORLD/COL): %.2f\n", world_reduce_time / col_reduce_time);
         
-        // сохраняем результаты в csv файл для последующего анализа
-        FILE* fp = fopen("cartesian_results.csv", "a");
-        if (fp != NULL) {
-            if (ftell(fp) == 0) {
-                fprintf(fp, "processes,grid_size,world_bcast,row_bcast,world_reduce,col_reduce\n");
-            }
-            fprintf(fp, "%d,%dx%d,%.6f,%.6f,%.6f,%.6f\n",
-                   world_size, rows, cols, world_time, row_time, world_reduce_time, col_reduce_time);
-            fclose(fp);
+        printf("\nMedian of %d repetitions (warmup %d):\n", cfg.reps, cfg.warmup);
+        for (int t = 0; t < 4; t++) {
+            bench_print(&results[t]);
+        }
+        
+        // сохраняем результаты (csv или json, путь по умолчанию или BENCH_OUTPUT)
+        char params[128];
+        snprintf(params, sizeof(params), "grid_size=%dx%d;data_size=%d;iterations=%d",
+                 rows, cols, DATA_SIZE, NUM_ITERATIONS);
+        for (int t = 0; t < 4; t++) {
+            bench_write("cartesian_results.csv", &results[t], params, 1, world_size);
         }
         
         printf("\n=== Summary ===\n");
@@ -1,6 +1,9 @@
 #!/bin/bash
 echo "=== Testing Cartesian Grid ==="
 
+# очищаем файл результатов (заголовок csv записывает сама программа)
+rm -f cartesian_results.csv
+
 # тестируем на разном количестве процессов, которые можно разложить в прямоугольную решетку
 for processes in 4 8 9 16; do
     echo "Testing with $processes processes..."
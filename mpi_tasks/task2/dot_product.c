@@ -3,6 +3,8 @@
 #include <mpi.h>        
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include "../../common/mixed_dot.h"
 
 // Функция генерации случайной части вектора (каждый процесс генерирует свою часть)
 void generate_vector_part(double *vector, int size, int seed_offset) {
@@ -22,8 +24,18 @@ double compute_local_dot_product(double *vec1, double *vec2, int local_size) {
     return local_dot;
 }
 
+// локальное скалярное произведение векторов, хранящихся в типе prec: одно и то же
+// ядро dot_typed (avx2 или скалярное по cpuid) для всех типов, чтобы сравнение
+// double/float/bf16 отличалось только типом хранения (float/bf16 - векторизованное
+// преобразование с накоплением в double)
+double compute_local_dot_product_typed(const void *vec1, const void *vec2, int local_size,
+                                       dot_precision_t prec) {
+    return dot_typed(vec1, vec2, local_size, prec);
+}
+
 // Функция проведения эксперимента с правильным замером времени
-void run_experiment(int vector_size, int use_processes, int world_rank, int world_size) {
+void run_experiment(int vector_size, int use_processes, int world_rank, int world_size,
+                    dot_precision_t prec) {
     MPI_Comm comm;
     int color = (world_rank < use_processes) ? 0 : MPI_UNDEFINED;
     MPI_Comm_split(MPI_COMM_WORLD, color, world_rank, &comm);
@@ -41,8 +53,14 @@ void run_experiment(int vector_size, int use_processes, int world_rank, int worl
         // Выделяем память под локальные части
         double *local_vec1 = (double *)malloc(local_size * sizeof(double));
         double *local_vec2 = (double *)malloc(local_size * sizeof(double));
+        // векторы в типе хранения (для double используются сами local_vec1/2)
+        void *store1 = local_vec1, *store2 = local_vec2;
+        if (prec != DOT_DOUBLE) {
+            store1 = malloc((size_t)local_size * dot_elem_size(prec));
+            store2 = malloc((size_t)local_size * dot_elem_size(prec));
+        }
         
-        if (local_vec1 == NULL || local_vec2 == NULL) {
+        if (local_vec1 == NULL || local_vec2 == NULL || store1 == NULL || store2 == NULL) {
             fprintf(stderr, "Process %d: Memory allocation failed!\n", rank);
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
@@ -55,26 +73,53 @@ void run_experiment(int vector_size, int use_processes, int world_rank, int worl
         generate_vector_part(local_vec1, local_size, rank * 2);       // Разные seed
         generate_vector_part(local_vec2, local_size, rank * 2 + 1);
         
-        // Вычисляем локальное скалярное произведение
-        double local_dot = compute_local_dot_product(local_vec1, local_vec2, local_size);
+        // Переводим в тип хранения (для double ничего не делаем); преобразование
+        // не входит в time, чтобы время было сравнимо с прежними запусками
+        double convert_start = MPI_Wtime();
+        if (prec != DOT_DOUBLE) {
+            dot_convert(store1, local_vec1, local_size, prec);
+            dot_convert(store2, local_vec2, local_size, prec);
+        }
+        double convert_time = MPI_Wtime() - convert_start;
+        
+        // Вычисляем локальное скалярное произведение (отдельно замеряем само ядро)
+        double kernel_start = MPI_Wtime();
+        double local_dot = compute_local_dot_product_typed(store1, store2, local_size, prec);
+        double kernel_time = MPI_Wtime() - kernel_start;
         
         // Собираем глобальный результат
         double global_dot;
         MPI_Reduce(&local_dot, &global_dot, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
         
         double end_time = MPI_Wtime();
-        double elapsed_time = end_time - start_time;
+        double elapsed_time = end_time - start_time - convert_time;
         
         // Находим максимальное время среди всех процессов
         double max_time;
         MPI_Reduce(&elapsed_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
         
+        // Точность относительно double: эталон по исходным векторам вне замера
+        double max_kernel_time, ref_dot = global_dot;
+        MPI_Reduce(&kernel_time, &max_kernel_time, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        if (prec != DOT_DOUBLE) {
+            double local_ref = compute_local_dot_product(local_vec1, local_vec2, local_size);
+            MPI_Reduce(&local_ref, &ref_dot, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+        }
+        
         // Процесс 0 выводит результаты
         if (rank == 0) {
             printf("PARALLEL: processes=%2d, vector_size=%-10d, time=%9.6f sec, dot=%.2f\n", 
                    size, vector_size, max_time, global_dot);
+            printf("  precision=%s, kernel_time=%9.6f sec, bandwidth=%.2f GB/s, rel_error=%.3e\n",
+                   dot_precision_name(prec), max_kernel_time,
+                   max_kernel_time > 0.0 ? 2.0 * vector_size * dot_elem_size(prec) / max_kernel_time / 1e9 : 0.0,
+                   ref_dot != 0.0 ? fabs(global_dot - ref_dot) / fabs(ref_dot) : 0.0);
         }
         
+        if (prec != DOT_DOUBLE) {
+            free(store1);
+            free(store2);
+        }
         free(local_vec1);
         free(local_vec2);
         MPI_Comm_free(&comm);
@@ -137,10 +182,25 @@ int main(int argc, char *argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     
+    // Тип хранения векторов: double (по умолчанию), float или bf16
+    dot_precision_t prec = DOT_DOUBLE;
+    if (argc > 1) {
+        int p = dot_precision_from_name(argv[1]);
+        if (p < 0) {
+            if (world_rank == 0) {
+                fprintf(stderr, "Unknown precision '%s' (expected double, float or bf16)\n", argv[1]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+        prec = (dot_precision_t)p;
+    }
+    
     if (world_rank == 0) {
         printf("=============================================================\n");
         printf("MPI Dot Product Performance Test\n");
         printf("Total available processes: %d\n", world_size);
+        printf("Storage precision: %s (kernel: %s)\n", dot_precision_name(prec), dot_kernel_name());
         printf("=============================================================\n");
     }
     
@@ -181,7 +241,7 @@ int main(int argc, char *argv[]) {
                 if (num_procs == 1 && vec_size > 10000000) continue;
                 if (num_procs == 2 && vec_size > 50000000) continue;
                 
-                run_experiment(vec_size, num_procs, world_rank, world_size);
+                run_experiment(vec_size, num_procs, world_rank, world_size, prec);
             }
         }
     }
@@ -4,6 +4,7 @@
 #include <math.h>
 #include <string.h>
 #include <time.h>
+#include "../../common/roofline.h"
 
 int main(int argc, char** argv) {
     // инициализация mpi, создание коммуникатора mpi_comm_world
@@ -131,6 +132,20 @@ int main(int argc, char** argv) {
     // mpi_reduce собирает данные со всех процессов и выполняет операцию (max)
     MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     
+    // roofline по запросу (ROOFLINE=1): все процессы одновременно измеряют свои потолки,
+    // потолок всей программы - сумма по процессам
+    roofline_t roof_local, roof_total;
+    int want_roofline = roofline_enabled();
+    if (want_roofline) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        roof_local = roofline_measure();
+        roof_total = roof_local;
+        MPI_Reduce(&roof_local.copy_gbs, &roof_total.copy_gbs, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&roof_local.triad_gbs, &roof_total.triad_gbs, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&roof_local.peak_gflops, &roof_total.peak_gflops, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        roof_total.threads = world_size;
+    }
+    
     // подготовка данных для сборки результатов на процессе 0
     int* recvcounts = NULL;
     int* displs = NULL;
@@ -182,6 +197,15 @@ int main(int argc, char** argv) {
         printf("%d,%d,%s,%.6f,check_equal=%s\n", 
                n, world_size, nodes_arg, max_time,
                equal ? "YES" : "NO");
+        
+        if (want_roofline) {
+            // элемент - одна итерация внутреннего цикла (n^3 всего): умножение и сложение;
+            // обязательный трафик: a и c по одному разу, b целиком в каждом процессе
+            double iterations = (double)n * n * n;
+            roofline_kernel_t band_kernel = {"band", 8.0 * (2.0 + world_size) * n * n / iterations, 2.0, 0};
+            roofline_print_machine(&roof_total);
+            roofline_report_with(&roof_total, &band_kernel, iterations, max_time);
+        }
                
         // освобождение памяти
         free(a_full);
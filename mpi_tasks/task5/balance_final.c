@@ -4,6 +4,42 @@
 #include <unistd.h>
 #include <time.h>
 #include <math.h>
+#include "../../common/bench_harness.h"
+
+// параметры одного прогона эксперимента (передаются в bench_run_mpi)
+typedef struct {
+    int rank, size;
+    int iterations;
+    int local_compute_us;
+    int comm_size;
+    char *send_buffer;
+    char *recv_buffer;
+} balance_ctx_t;
+
+// один прогон: iterations раз вычисления + кольцевой обмен
+void balance_iterations(void *arg) {
+    balance_ctx_t *ctx = (balance_ctx_t *)arg;
+    for (int iter = 0; iter < ctx->iterations; iter++) {
+        // фаза вычислений (масштабируется с количеством процессов)
+        // используем usleep для эмуляции вычислительной нагрузки
+        if (ctx->local_compute_us > 0) {
+            usleep(ctx->local_compute_us);
+        }
+        
+        // фаза коммуникаций (пропорциональна вычислениям)
+        // выполняем обмен сообщениями по кольцевой топологии
+        if (ctx->size > 1 && ctx->comm_size > 0) {
+            int next = (ctx->rank + 1) % ctx->size;  // следующий процесс в кольце
+            int prev = (ctx->rank - 1 + ctx->size) % ctx->size;  // предыдущий процесс в кольце
+            
+            // одновременная отправка и прием сообщений
+            // каждый процесс отправляет следующему и принимает от предыдущего
+            MPI_Sendrecv(ctx->send_buffer, ctx->comm_size, MPI_BYTE, next, 0,
+                        ctx->recv_buffer, ctx->comm_size, MPI_BYTE, prev, 0,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    }
+}
 
 int main(int argc, char** argv) {
     int rank, size;
@@ -24,7 +60,8 @@ int main(int argc, char** argv) {
     if (argc > 2) bytes_per_second = atof(argv[2]);
     if (argc > 3) iterations = atoi(argv[3]);
     
-    double start_time, end_time;
+    // повторения эксперимента: BENCH_WARMUP / BENCH_REPS (по умолчанию без прогрева, 3 повторения)
+    bench_config_t cfg = bench_config_from_env(0, 3);
     
     // вычисления: масштабируем с количеством процессов - каждый процесс делает total_compute/size работы
     // это эмулирует идеальное распараллеливание вычислений
@@ -47,9 +84,7 @@ int main(int argc, char** argv) {
         // вычисляем соотношение вычислений к коммуникациям
         printf("Compute/Comm ratio (N/M): %.6f\n", total_compute / (bytes_per_second / 1000000.0));
         printf("Iterations: %d\n", iterations);
-        
-        // начинаем замер общего времени выполнения
-        start_time = MPI_Wtime();
+        printf("Repetitions: %d (warmup %d)\n", cfg.reps, cfg.warmup);
     }
     
     // выделяем буферы для коммуникаций
@@ -61,35 +96,16 @@ int main(int argc, char** argv) {
         send_buffer[i] = (char)(rank + i);
     }
     
-    // синхронизируем все процессы перед началом эксперимента
-    MPI_Barrier(MPI_COMM_WORLD);
-    
-    // основной цикл эксперимента
-    for (int iter = 0; iter < iterations; iter++) {
-        // фаза вычислений (масштабируется с количеством процессов)
-        // используем usleep для эмуляции вычислительной нагрузки
-        if (local_compute_us > 0) {
-            usleep(local_compute_us);
-        }
-        
-        // фаза коммуникаций (пропорциональна вычислениям)
-        // выполняем обмен сообщениями по кольцевой топологии
-        if (size > 1 && comm_size > 0) {
-            int next = (rank + 1) % size;  // следующий процесс в кольце
-            int prev = (rank - 1 + size) % size;  // предыдущий процесс в кольце
-            
-            // одновременная отправка и прием сообщений
-            // каждый процесс отправляет следующему и принимает от предыдущего
-            MPI_Sendrecv(send_buffer, comm_size, MPI_BYTE, next, 0,
-                        recv_buffer, comm_size, MPI_BYTE, prev, 0,
-                        MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        }
-    }
+    // основной цикл эксперимента повторяется cfg.reps раз,
+    // перед каждым повторением процессы синхронизируются барьером
+    balance_ctx_t ctx = {rank, size, iterations, local_compute_us, comm_size,
+                         send_buffer, recv_buffer};
+    bench_result_t result;
+    bench_run_mpi("balance", balance_iterations, &ctx, cfg, MPI_COMM_WORLD, &result);
     
     // расчет метрик производительности на процессе 0
     if (rank == 0) {
-        end_time = MPI_Wtime();
-        double parallel_time = end_time - start_time;
+        double parallel_time = result.median;  // медиана по повторениям
         
         // ускорение (speedup) - отношение последовательного времени к параллельному
         double sequential_time = total_compute * iterations; // время на 1 процессе
@@ -99,26 +115,23 @@ int main(int argc, char** argv) {
         
         printf("\n=== RESULTS ===\n");
         printf("Sequential time (estimated): %.4f s\n", sequential_time);
-        printf("Parallel time: %.4f s\n", parallel_time);
+        printf("Parallel time (median): %.4f s\n", parallel_time);
+        printf("Parallel time: min %.4f s, p95 %.4f s, mean %.4f ± %.4f s (95%% CI), outliers %d/%d\n",
+               result.min, result.p95, result.mean, (result.ci_high - result.ci_low) / 2.0,
+               result.outliers, result.reps);
         printf("Speedup: %.2f\n", speedup);
         printf("Efficiency: %.1f%%\n", efficiency);
         printf("================\n");
         
-        // сохраняем результаты в CSV файл для последующего анализа
-        FILE* fp = fopen("balance_final_results.csv", "a");
-        if (fp != NULL) {
-            // если файл пустой, записываем заголовок
-            if (ftell(fp) == 0) {
-                fprintf(fp, "processes,total_compute,bytes_per_second,ratio,compute_per_process,comm_size,parallel_time,speedup,efficiency\n");
-            }
-            // вычисляем соотношение вычисления/коммуникации
-            double ratio = total_compute / (bytes_per_second / 1000000.0);
-            // записываем строку с результатами
-            fprintf(fp, "%d,%.2f,%.0f,%.6f,%.4f,%d,%.4f,%.2f,%.1f\n", 
-                   size, total_compute, bytes_per_second, ratio,
-                   local_compute_time, comm_size, parallel_time, speedup, efficiency);
-            fclose(fp);
-        }
+        // сохраняем результаты (csv или json, путь по умолчанию или BENCH_OUTPUT)
+        double ratio = total_compute / (bytes_per_second / 1000000.0);
+        char params[256];
+        snprintf(params, sizeof(params),
+                 "total_compute=%.2f;bytes_per_second=%.0f;ratio=%.6f;compute_per_process=%.4f;"
+                 "comm_size=%d;speedup=%.2f;efficiency=%.1f",
+                 total_compute, bytes_per_second, ratio, local_compute_time,
+                 comm_size, speedup, efficiency);
+        bench_write("balance_final_results.csv", &result, params, 1, size);
     }
     
     // освобождаем память
@@ -1,8 +1,9 @@
 #!/bin/bash
 echo "=== FINAL Balance Experiments ==="
 
-# очищаем файл результатов и записываем заголовок CSV
-echo "processes,total_compute,bytes_per_second,ratio,compute_per_process,comm_size,parallel_time,speedup,efficiency" > balance_final_results.csv
+# очищаем файл результатов (заголовок CSV записывает сама программа)
+# число повторений каждого эксперимента задается BENCH_REPS (по умолчанию 3)
+rm -f balance_final_results.csv
 
 # тестируем разные соотношения вычислений и коммуникаций (N/M)
 
@@ -5,8 +5,8 @@ echo "=== MPI Task 9: Collective Operations Comprehensive Analysis ==="
 echo "Compiling collective operations..."
 mpicc -O2 collective_operations.c -o collective_operations -lm
 
-# очищаем файл результатов и записываем заголовок
-echo "operation,data_size,processes,mpi_time,my_time,ratio" > collective_results.csv
+# очищаем файл результатов (заголовок записывает сама программа)
+rm -f collective_results.csv
 
 # расширенное тестирование с разными конфигурациями кластера
 echo "1. Testing intra-node communication (4 processes, 1 node)"
@@ -28,8 +28,13 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import numpy as np
 
-# загрузка данных из csv файла
-df = pd.read_csv('collective_results.csv')
+# загрузка данных из csv файла: по строке на каждую реализацию (impl = mpi / my),
+# время повторения - медиана по BENCH_REPS замерам
+raw = pd.read_csv('collective_results.csv')
+df = raw.pivot_table(index=['operation', 'data_size', 'ranks'], columns='impl',
+                     values='median').reset_index()
+df = df.rename(columns={'ranks': 'processes', 'mpi': 'mpi_time', 'my': 'my_time'})
+df['ratio'] = df['mpi_time'] / df['my_time']
 
 # группировка данных по операциям и количеству процессов для статистики
 summary = df.groupby(['operation', 'processes']).agg({
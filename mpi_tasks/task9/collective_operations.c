@@ -4,6 +4,7 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include "../../common/bench_harness.h"
 
 // собственная реализация Broadcast через последовательную отправку от корня ко всем
 void my_bcast(void* buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
@@ -137,8 +138,70 @@ void my_allreduce(void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype
     my_bcast(recvbuf, count, datatype, 0, comm);
 }
 
+// параметры одного замера коллективной операции (передаются в bench_run_mpi)
+typedef struct {
+    const char* operation;
+    int use_mpi;         // 1 - стандартная MPI реализация, 0 - собственная
+    int data_size;
+    int num_trials;
+    double* send_data;
+    double* recv_data;
+    MPI_Comm comm;
+} collective_ctx_t;
+
+// одно повторение замера: num_trials вызовов выбранной операции
+void run_collective_trials(void* arg) {
+    collective_ctx_t* ctx = (collective_ctx_t*)arg;
+    const char* operation = ctx->operation;
+    int data_size = ctx->data_size;
+    double* send_data = ctx->send_data;
+    double* recv_data = ctx->recv_data;
+    MPI_Comm comm = ctx->comm;
+    
+    for (int trial = 0; trial < ctx->num_trials; trial++) {
+        if (ctx->use_mpi) {
+            // выполняем соответствующую MPI операцию много раз для точности измерения
+            if (strcmp(operation, "Bcast") == 0) {
+                MPI_Bcast(send_data, data_size, MPI_DOUBLE, 0, comm);
+            } else if (strcmp(operation, "Reduce") == 0) {
+                MPI_Reduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, 0, comm);
+            } else if (strcmp(operation, "Scatter") == 0) {
+                MPI_Scatter(send_data, data_size, MPI_DOUBLE, recv_data, 
+                           data_size, MPI_DOUBLE, 0, comm);
+            } else if (strcmp(operation, "Gather") == 0) {
+                MPI_Gather(send_data, data_size, MPI_DOUBLE, recv_data, 
+                          data_size, MPI_DOUBLE, 0, comm);
+            } else if (strcmp(operation, "Allgather") == 0) {
+                MPI_Allgather(send_data, data_size, MPI_DOUBLE, recv_data, 
+                             data_size, MPI_DOUBLE, comm);
+            } else if (strcmp(operation, "Allreduce") == 0) {
+                MPI_Allreduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, comm);
+            }
+        } else {
+            // выполняем соответствующую собственную операцию много раз
+            if (strcmp(operation, "Bcast") == 0) {
+                my_bcast(send_data, data_size, MPI_DOUBLE, 0, comm);
+            } else if (strcmp(operation, "Reduce") == 0) {
+                my_reduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, 0, comm);
+            } else if (strcmp(operation, "Scatter") == 0) {
+                my_scatter(send_data, data_size, MPI_DOUBLE, recv_data, 
+                          data_size, 0, comm);
+            } else if (strcmp(operation, "Gather") == 0) {
+                my_gather(send_data, data_size, MPI_DOUBLE, recv_data, 
+                         data_size, 0, comm);
+            } else if (strcmp(operation, "Allgather") == 0) {
+                my_allgather(send_data, data_size, MPI_DOUBLE, recv_data, 
+                            data_size, comm);
+            } else if (strcmp(operation, "Allreduce") == 0) {
+                my_allreduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, comm);
+            }
+        }
+    }
+}
+
 // функция для тестирования коллективных операций
-void test_collective(const char* operation, int data_size, int num_trials, MPI_Comm comm) {
+void test_collective(const char* operation, int data_size, int num_trials, 
+                     bench_config_t cfg, MPI_Comm comm) {
     int rank, size;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
@@ -146,7 +209,6 @@ void test_collective(const char* operation, int data_size, int num_trials, MPI_C
     // выделяем память для данных
     double* send_data = malloc(data_size * sizeof(double));
     double* recv_data = malloc(data_size * size * sizeof(double));
-    double* temp_data = malloc(data_size * size * sizeof(double));
     
     // инициализация тестовых данных случайными числами
     srand(time(NULL) + rank);
@@ -159,80 +221,46 @@ void test_collective(const char* operation, int data_size, int num_trials, MPI_C
                operation, data_size, size);
     }
     
-    // тестируем стандартную MPI реализацию
-    MPI_Barrier(comm); // синхронизация перед началом измерения
-    double mpi_start = MPI_Wtime(); // начинаем замер времени
+    // каждое повторение - num_trials вызовов; барьер перед повторением,
+    // время повторения - максимум по процессам
+    collective_ctx_t ctx = {operation, 1, data_size, num_trials, send_data, recv_data, comm};
+    bench_result_t mpi_result, my_result;
+    char name[BENCH_NAME_LEN];
     
-    for (int trial = 0; trial < num_trials; trial++) {
-        // выполняем соответствующую MPI операцию много раз для точности измерения
-        if (strcmp(operation, "Bcast") == 0) {
-            MPI_Bcast(send_data, data_size, MPI_DOUBLE, 0, comm);
-        } else if (strcmp(operation, "Reduce") == 0) {
-            MPI_Reduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, 0, comm);
-        } else if (strcmp(operation, "Scatter") == 0) {
-            MPI_Scatter(send_data, data_size, MPI_DOUBLE, recv_data, 
-                       data_size, MPI_DOUBLE, 0, comm);
-        } else if (strcmp(operation, "Gather") == 0) {
-            MPI_Gather(send_data, data_size, MPI_DOUBLE, recv_data, 
-                      data_size, MPI_DOUBLE, 0, comm);
-        } else if (strcmp(operation, "Allgather") == 0) {
-            MPI_Allgather(send_data, data_size, MPI_DOUBLE, recv_data, 
-                         data_size, MPI_DOUBLE, comm);
-        } else if (strcmp(operation, "Allreduce") == 0) {
-            MPI_Allreduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, comm);
-        }
-    }
-    
-    double mpi_end = MPI_Wtime(); // заканчиваем замер времени
-    double mpi_time = mpi_end - mpi_start; // вычисляем общее время
+    // тестируем стандартную MPI реализацию
+    snprintf(name, sizeof(name), "MPI_%s", operation);
+    bench_run_mpi(name, run_collective_trials, &ctx, cfg, comm, &mpi_result);
     
     // тестируем собственную реализацию
-    MPI_Barrier(comm); // синхронизация перед началом измерения
-    double my_start = MPI_Wtime(); // начинаем замер времени
+    ctx.use_mpi = 0;
+    snprintf(name, sizeof(name), "my_%s", operation);
+    bench_run_mpi(name, run_collective_trials, &ctx, cfg, comm, &my_result);
     
-    for (int trial = 0; trial < num_trials; trial++) {
-        // выполняем соответствующую собственную операцию много раз
-        if (strcmp(operation, "Bcast") == 0) {
-            my_bcast(send_data, data_size, MPI_DOUBLE, 0, comm);
-        } else if (strcmp(operation, "Reduce") == 0) {
-            my_reduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, 0, comm);
-        } else if (strcmp(operation, "Scatter") == 0) {
-            my_scatter(send_data, data_size, MPI_DOUBLE, recv_data, 
-                      data_size, 0, comm);
-        } else if (strcmp(operation, "Gather") == 0) {
-            my_gather(send_data, data_size, MPI_DOUBLE, recv_data, 
-                     data_size, 0, comm);
-        } else if (strcmp(operation, "Allgather") == 0) {
-            my_allgather(send_data, data_size, MPI_DOUBLE, recv_data, 
-                        data_size, comm);
-        } else if (strcmp(operation, "Allreduce") == 0) {
-            my_allreduce(send_data, recv_data, data_size, MPI_DOUBLE, MPI_SUM, comm);
-        }
-    }
-    
-    double my_end = MPI_Wtime(); // заканчиваем замер времени
-    double my_time = my_end - my_start; // вычисляем общее время
+    double mpi_time = mpi_result.median;  // медиана по повторениям
+    double my_time = my_result.median;
     
     // вывод результатов и сохранение в файл
     if (rank == 0) {
-        printf("MPI %s: %.6f seconds\n", operation, mpi_time);
-        printf("My %s:  %.6f seconds\n", operation, my_time);
+        printf("MPI %s: %.6f seconds (median of %d, p95 %.6f)\n", 
+               operation, mpi_time, mpi_result.reps, mpi_result.p95);
+        printf("My %s:  %.6f seconds (median of %d, p95 %.6f)\n", 
+               operation, my_time, my_result.reps, my_result.p95);
         printf("Ratio (MPI/My): %.2f\n", mpi_time / my_time);
         printf("---\n");
         
-        // сохраняем результаты в csv файл
-        FILE* fp = fopen("collective_results.csv", "a");
-        if (fp != NULL) {
-            fprintf(fp, "%s,%d,%d,%.6f,%.6f,%.2f\n", 
-                   operation, data_size, size, mpi_time, my_time, mpi_time/my_time);
-            fclose(fp);
-        }
+        // сохраняем результаты (csv или json, путь по умолчанию или BENCH_OUTPUT)
+        char params[128];
+        snprintf(params, sizeof(params), "operation=%s;data_size=%d;trials=%d;impl=mpi",
+                 operation, data_size, num_trials);
+        bench_write("collective_results.csv", &mpi_result, params, 1, size);
+        snprintf(params, sizeof(params), "operation=%s;data_size=%d;trials=%d;impl=my",
+                 operation, data_size, num_trials);
+        bench_write("collective_results.csv", &my_result, params, 1, size);
     }
     
     // освобождаем выделенную память
     free(send_data);
     free(recv_data);
-    free(temp_data);
 }
 
 int main(int argc, char** argv) {
@@ -255,13 +283,16 @@ int main(int argc, char** argv) {
     };
     int num_operations = sizeof(operations) / sizeof(operations[0]);
     
-    const int NUM_TRIALS = 100; // количество повторений для каждого теста
+    const int NUM_TRIALS = 100; // количество вызовов операции в одном повторении замера
+    
+    // повторения замера: BENCH_WARMUP / BENCH_REPS (по умолчанию 2 прогревочных, 10 измеряемых)
+    bench_config_t cfg = bench_config_from_env(2, 10);
     
     // тестируем все комбинации операций и размеров данных
     for (int op_idx = 0; op_idx < num_operations; op_idx++) {
         for (int size_idx = 0; size_idx < num_sizes; size_idx++) {
             test_collective(operations[op_idx], data_sizes[size_idx], 
-                          NUM_TRIALS, MPI_COMM_WORLD);
+                          NUM_TRIALS, cfg, MPI_COMM_WORLD);
         }
     }
     
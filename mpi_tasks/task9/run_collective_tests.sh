@@ -1,8 +1,8 @@
 #!/bin/bash
 echo "=== Testing Collective Operations ==="
 
-# очищаем файл результатов и записываем заголовок csv
-echo "operation,data_size,processes,mpi_time,my_time,ratio" > collective_results.csv
+# очищаем файл результатов (заголовок csv записывает сама программа)
+rm -f collective_results.csv
 
 # тестируем на разном количестве процессов: 4, 8 и 16
 for processes in 4 8 16; do
@@ -2,12 +2,20 @@
 #include <stdlib.h>
 #include <omp.h>
 #include <time.h>
+#include "../../common/philox_rng.h"
+#include "../../common/simd_minmax.h"
+#include "../../common/fused_stats.h"
+#include "../../common/numa_alloc.h"
+#include "../../common/roofline.h"
+#include "../../common/loop_profile.h"
+
+// элементов в блоке версии с критическими секциями (одна итерация цикла - блок)
+#define MINMAX_BLOCK 4096
 
 // функция для заполнения массива случайными числами
-void fill_array(double *arr, int size) {
-    for (int i = 0; i < size; i++) {
-        arr[i] = (double)rand() / RAND_MAX * 1000.0;  // генерируем числа от 0 до 1000
-    }
+// счетчиковый генератор philox: параллельно и одинаково при любом числе потоков
+void fill_array(double *arr, int size, uint64_t seed) {
+    rng_fill_uniform(arr, size, seed, 0, 0.0, 1000.0);  // генерируем числа от 0 до 1000
 }
 
 int main(int argc, char *argv[]) {
@@ -18,17 +26,29 @@ int main(int argc, char *argv[]) {
     }
     
     // выделяем память под массив типа double
-    double *array = (double*)malloc(size * sizeof(double));
+    // страницы размещаются параллельным первым касанием на узлах numa тех потоков,
+    // которые потом их обрабатывают (schedule(static))
+    double *array = (double*)numa_alloc_first_touch(size, sizeof(double));
     if (array == NULL) {
         printf("ошибка выделения памяти!\n");
         return 1;
     }
     
-    // инициализируем генератор случайных чисел текущим временем
-    srand(time(NULL));
-    fill_array(array, size);  // заполняем массив случайными значениями
+    // seed фиксирован (или задается через RNG_SEED), поэтому запуски воспроизводимы
+    uint64_t seed = rng_seed_from_env();
+    double fill_start = omp_get_wtime();
+    fill_array(array, size, seed);  // заполняем массив случайными значениями
+    double fill_time = omp_get_wtime() - fill_start;
     
     printf("размер массива: %d элементов\n", size);
+    printf("seed: %llu, генерация данных: %.4f секунд\n", (unsigned long long)seed, fill_time);
+    printf("simd-ядро: %s\n", minmax_kernel_name());  // выбирается по cpuid один раз
+    numa_print_binding();  // OMP_PLACES / OMP_PROC_BIND и размещение потоков по узлам
+    if (roofline_enabled()) roofline_print_machine(roofline_get());  // stream и пик fma этой машины
+
+    double bytes = (double)size * sizeof(double);  // объем данных, читаемых за один проход
+    // на элемент: чтение 8 байт и два сравнения (min и max)
+    roofline_kernel_t minmax_kernel = {"min/max", sizeof(double), 2.0, 0};
     
     // здесь будем добавлять разные версии алгоритмов
 
@@ -48,6 +68,19 @@ int main(int argc, char *argv[]) {
     printf("последовательная версия:\n");
     printf("  минимум: %.2f, максимум: %.2f\n", seq_min, seq_max);
     printf("  время: %.4f секунд\n", seq_time);
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / seq_time / 1e9);
+
+    // последовательная версия через векторизованное ядро
+    double simd_min, simd_max;
+    double simd_start = omp_get_wtime();
+    minmax_simd(array, size, &simd_min, &simd_max);  // sse2/avx2/avx-512 с несколькими аккумуляторами
+    double simd_time = omp_get_wtime() - simd_start;
+
+    printf("\nпоследовательная версия (simd):\n");
+    printf("  минимум: %.2f, максимум: %.2f\n", simd_min, simd_max);
+    printf("  время: %.4f секунд\n", simd_time);
+    printf("  ускорение: %.2fx\n", seq_time / simd_time);
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / simd_time / 1e9);
 
         // параллельная версия с использованием редукции
     double red_min = array[0];  // начальное значение минимума
@@ -68,10 +101,56 @@ int main(int argc, char *argv[]) {
     printf("  минимум: %.2f, максимум: %.2f\n", red_min, red_max);
     printf("  время: %.4f секунд\n", red_time);
     printf("  ускорение: %.2fx\n", seq_time / red_time);  // вычисляем ускорение
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / red_time / 1e9);
+    roofline_report(&minmax_kernel, size, red_time);
+
+    // параллельная версия с редукцией, каждый поток обрабатывает свой блок simd-ядром
+    double red_simd_min = array[0];
+    double red_simd_max = array[0];
+    int max_threads = omp_get_max_threads();
+    int used_threads = 1;
+    numa_thread_bw_t *thread_bw = (numa_thread_bw_t*)calloc(max_threads, sizeof(numa_thread_bw_t));
+    double red_simd_start = omp_get_wtime();
+
+    #pragma omp parallel reduction(min:red_simd_min) reduction(max:red_simd_max)
+    {
+        // делим массив на непрерывные блоки так же, как schedule(static) -
+        // поток читает ровно те страницы, которых он первым коснулся при выделении
+        long begin, end;
+        numa_static_range(size, &begin, &end);
+        double thread_start = omp_get_wtime();
+
+        if (end > begin) {
+            double local_min, local_max;
+            minmax_simd(array + begin, end - begin, &local_min, &local_max);
+            red_simd_min = local_min;  // openmp объединит значения потоков
+            red_simd_max = local_max;
+        }
+
+        // замер потока для отчета по сокетам
+        if (thread_bw != NULL) {
+            numa_record(&thread_bw[omp_get_thread_num()], (double)(end - begin) * sizeof(double),
+                        omp_get_wtime() - thread_start);
+        }
+        #pragma omp single nowait
+        used_threads = omp_get_num_threads();
+    }
+
+    double red_simd_time = omp_get_wtime() - red_simd_start;
+
+    printf("\nпараллельная версия (редукция + simd):\n");
+    printf("  минимум: %.2f, максимум: %.2f\n", red_simd_min, red_simd_max);
+    printf("  время: %.4f секунд\n", red_simd_time);
+    printf("  ускорение: %.2fx\n", seq_time / red_simd_time);
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / red_simd_time / 1e9);
+    roofline_report(&minmax_kernel, size, red_simd_time);
+    numa_print_socket_bandwidth(thread_bw, used_threads);
+    free(thread_bw);
 
         // параллельная версия без редукции с использованием критических секций
     double crit_min = array[0];  // начальное значение минимума
     double crit_max = array[0];  // начальное значение максимума
+    loop_profile_t *profile = loop_profile_begin("critical");  // NULL без LOOP_PROFILE=1
     double crit_start = omp_get_wtime();  // засекаем время начала
     
     #pragma omp parallel
@@ -79,12 +158,18 @@ int main(int argc, char *argv[]) {
         double local_min = array[0];  // локальный минимум для каждого потока
         double local_max = array[0];  // локальный максимум для каждого потока
         
-        // распределяем итерации цикла между потоками
-        #pragma omp for
-        for (int i = 0; i < size; i++) {
-            if (array[i] < local_min) local_min = array[i];  // поток находит минимум в своей части
-            if (array[i] > local_max) local_max = array[i];  // поток находит максимум в своей части
-        }
+        // распределяем блоки по MINMAX_BLOCK элементов между потоками: schedule(static)
+        // дает потоку непрерывный отрезок массива, каждый блок - simd-ядро
+        loop_probe_t probe = loop_probe_start(profile);
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait",
+                         (int lo = 0; lo < size; lo += MINMAX_BLOCK), lo / MINMAX_BLOCK, LOOP_CHUNK_STATIC,
+            int len = (size - lo < MINMAX_BLOCK) ? size - lo : MINMAX_BLOCK;
+            double block_min, block_max;
+            minmax_simd(array + lo, len, &block_min, &block_max);
+            if (block_min < local_min) local_min = block_min;  // поток находит минимум в своей части
+            if (block_max > local_max) local_max = block_max;  // поток находит максимум в своей части
+        );
+        loop_probe_finish(profile, &probe);  // барьер вместо неявного у omp for
         
         // критическая секция для безопасного обновления глобального минимума
         #pragma omp critical
@@ -105,6 +190,60 @@ int main(int argc, char *argv[]) {
     printf("  минимум: %.2f, максимум: %.2f\n", crit_min, crit_max);
     printf("  время: %.4f секунд\n", crit_time);
     printf("  ускорение: %.2fx\n", seq_time / crit_time);  // вычисляем ускорение
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / crit_time / 1e9);
+    loop_profile_report(profile);
+
+    // многопроходная статистика: отдельный проход по массиву на каждую величину
+    double multi_start = omp_get_wtime();
+    long multi_argmin = 0, multi_argmax = 0;
+    for (int i = 1; i < size; i++) {  // проход 1: минимум и его индекс
+        if (array[i] < array[multi_argmin]) multi_argmin = i;
+    }
+    for (int i = 1; i < size; i++) {  // проход 2: максимум и его индекс
+        if (array[i] > array[multi_argmax]) multi_argmax = i;
+    }
+    double multi_sum = 0.0;
+    for (int i = 0; i < size; i++) {  // проход 3: сумма и среднее
+        multi_sum += array[i];
+    }
+    double multi_mean = multi_sum / size;
+    double multi_m2 = 0.0;
+    for (int i = 0; i < size; i++) {  // проход 4: дисперсия
+        multi_m2 += (array[i] - multi_mean) * (array[i] - multi_mean);
+    }
+    double multi_time = omp_get_wtime() - multi_start;
+
+    printf("\nстатистика (многопроходная версия, 4 прохода):\n");
+    printf("  минимум: %.2f [%ld], максимум: %.2f [%ld]\n",
+           array[multi_argmin], multi_argmin, array[multi_argmax], multi_argmax);
+    printf("  среднее: %.6f, дисперсия: %.6f\n", multi_mean, multi_m2 / size);
+    printf("  время: %.4f секунд\n", multi_time);
+
+    // однопроходная статистика: все величины за одно чтение массива
+    double fused_start = omp_get_wtime();
+    array_stats_t fused = stats_compute(array, size, 0);
+    double fused_time = omp_get_wtime() - fused_start;
+
+    printf("\nстатистика (однопроходная версия):\n");
+    printf("  минимум: %.2f [%ld], максимум: %.2f [%ld]\n",
+           fused.min, fused.argmin, fused.max, fused.argmax);
+    printf("  среднее: %.6f, дисперсия: %.6f\n", fused.mean, stats_variance(fused, 0));
+    printf("  время: %.4f секунд\n", fused_time);
+    printf("  ускорение: %.2fx\n", multi_time / fused_time);  // относительно многопроходной версии
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / fused_time / 1e9);
+
+    // параллельная однопроходная статистика с пользовательской редукцией merge_stats
+    double par_stats_start = omp_get_wtime();
+    array_stats_t par_stats = stats_compute_parallel(array, size, 0);
+    double par_stats_time = omp_get_wtime() - par_stats_start;
+
+    printf("\nстатистика (параллельная однопроходная версия):\n");
+    printf("  минимум: %.2f [%ld], максимум: %.2f [%ld]\n",
+           par_stats.min, par_stats.argmin, par_stats.max, par_stats.argmax);
+    printf("  среднее: %.6f, дисперсия: %.6f\n", par_stats.mean, stats_variance(par_stats, 0));
+    printf("  время: %.4f секунд\n", par_stats_time);
+    printf("  ускорение: %.2fx\n", multi_time / par_stats_time);
+    printf("  пропускная способность: %.2f ГБ/с\n", bytes / par_stats_time / 1e9);
 
     free(array);  // освобождаем память, выделенную под массив
     return 0;
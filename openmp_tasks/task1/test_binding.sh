@@ -0,0 +1,12 @@
+#!/bin/bash
+echo "сравнение режимов привязки потоков (numa):"
+echo "=========================================="
+
+# массив выделяется с параллельным первым касанием, поэтому при привязке потоков
+# к ядрам каждый сокет читает свою локальную память
+THREADS=${1:-16}
+for bind in false close spread; do
+    echo "--- OMP_PLACES=cores OMP_PROC_BIND=$bind, $THREADS потоков ---"
+    OMP_PLACES=cores OMP_PROC_BIND=$bind OMP_NUM_THREADS=$THREADS ./min_max 100000000
+    echo ""
+done
@@ -3,36 +3,235 @@
 #include <omp.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include "../../common/philox_rng.h"
+#include "../../common/numa_alloc.h"
+#include "../../common/mixed_dot.h"
+#include "../../common/batched_dot.h"
+#include "../../common/bench_harness.h"
+#include "../../common/roofline.h"
+#include "../../common/loop_profile.h"
 
 // функция для заполнения векторов случайными числами
-void fill_vectors(double *vec1, double *vec2, int size) {
-    for (int i = 0; i < size; i++) {
-        vec1[i] = (double)rand() / RAND_MAX * 10.0;  // генерируем числа от 0 до 10 для первого вектора
-        vec2[i] = (double)rand() / RAND_MAX * 10.0;  // генерируем числа от 0 до 10 для второго вектора
+// каждый вектор - свой поток (stream) генератора philox, заполнение параллельное
+void fill_vectors(double *vec1, double *vec2, int size, uint64_t seed) {
+    rng_fill_uniform(vec1, size, seed, 0, 0.0, 10.0);  // генерируем числа от 0 до 10 для первого вектора
+    rng_fill_uniform(vec2, size, seed, 1, 0.0, 10.0);  // генерируем числа от 0 до 10 для второго вектора
+}
+
+// воспроизводимое скалярное произведение:
+// вектор делится на блоки фиксированного размера REPRO_BLOCK, каждый блок
+// суммируется одинаково независимо от того, какой поток его обработал, а частичные
+// суммы блоков складываются деревом фиксированной формы (зависит только от числа блоков).
+// поэтому результат побитово совпадает при любом числе потоков
+#define REPRO_BLOCK 4096  // элементов в блоке
+#define REPRO_LANES 8     // независимых аккумуляторов внутри блока (векторизуются)
+
+// сумма одного блока: 8 аккумуляторов, при compensated - компенсация ноймайера
+double repro_block_dot(const double *x, const double *y, long n, int compensated) {
+    double acc[REPRO_LANES] = {0.0};
+    double comp[REPRO_LANES] = {0.0};  // накопленная ошибка округления каждого аккумулятора
+    long i = 0;
+    
+    if (compensated) {
+        for (; i + REPRO_LANES <= n; i += REPRO_LANES) {
+            for (int k = 0; k < REPRO_LANES; k++) {
+                double p = x[i + k] * y[i + k];
+                double t = acc[k] + p;
+                // ноймайер: теряется младшая часть меньшего по модулю слагаемого
+                comp[k] += (fabs(acc[k]) >= fabs(p)) ? (acc[k] - t) + p : (p - t) + acc[k];
+                acc[k] = t;
+            }
+        }
+    } else {
+        for (; i + REPRO_LANES <= n; i += REPRO_LANES) {
+            for (int k = 0; k < REPRO_LANES; k++) {
+                acc[k] += x[i + k] * y[i + k];
+            }
+        }
+    }
+    for (int k = 0; i < n; i++, k++) {  // хвост блока (только у последнего блока)
+        acc[k] += x[i] * y[i];
+    }
+    
+    // попарное объединение аккумуляторов в фиксированном порядке
+    for (int k = 0; k < REPRO_LANES; k++) {
+        acc[k] += comp[k];
+    }
+    for (int width = REPRO_LANES / 2; width > 0; width /= 2) {
+        for (int k = 0; k < width; k++) {
+            acc[k] += acc[k + width];
+        }
+    }
+    return acc[0];
+}
+
+// попарная сумма частичных сумм: форма дерева зависит только от n
+double repro_pairwise_sum(const double *v, long n) {
+    if (n == 0) return 0.0;
+    if (n == 1) return v[0];
+    long half = n / 2;
+    return repro_pairwise_sum(v, half) + repro_pairwise_sum(v + half, n - half);
+}
+
+// то же дерево без массива частичных сумм: блоки first..first+count-1 считаются
+// по ходу обхода (последовательно, результат побитово тот же)
+double repro_tree_dot(const double *x, const double *y, long n, long first, long count,
+                      int compensated) {
+    if (count == 0) return 0.0;
+    if (count == 1) {
+        long lo = first * REPRO_BLOCK;
+        long len = (n - lo < REPRO_BLOCK) ? n - lo : REPRO_BLOCK;
+        return repro_block_dot(x + lo, y + lo, len, compensated);
     }
+    long half = count / 2;
+    return repro_tree_dot(x, y, n, first, half, compensated) +
+           repro_tree_dot(x, y, n, first + half, count - half, compensated);
+}
+
+// воспроизводимое параллельное скалярное произведение
+double repro_dot(const double *x, const double *y, long n, int compensated) {
+    long nblocks = (n + REPRO_BLOCK - 1) / REPRO_BLOCK;
+    double *partial = (double*)malloc((nblocks > 0 ? nblocks : 1) * sizeof(double));
+    if (partial == NULL) {
+        // не хватает памяти под частичные суммы - тот же результат последовательно
+        return repro_tree_dot(x, y, n, 0, nblocks, compensated);
+    }
+    
+    // блоки независимы - любое распределение по потокам дает те же частичные суммы
+    #pragma omp parallel for schedule(static)
+    for (long b = 0; b < nblocks; b++) {
+        long lo = b * REPRO_BLOCK;
+        long len = (n - lo < REPRO_BLOCK) ? n - lo : REPRO_BLOCK;
+        partial[b] = repro_block_dot(x + lo, y + lo, len, compensated);
+    }
+    
+    double result = repro_pairwise_sum(partial, nblocks);
+    free(partial);
+    return result;
+}
+
+// параметры одного замера пакетного режима
+typedef struct {
+    dot_batch_t batch;
+    double *out;
+    int mode;  // 0 - отдельный parallel for на каждую пару, иначе стратегия dot_batch
+} batch_ctx_t;
+
+void batch_iteration(void *arg) {
+    batch_ctx_t *ctx = (batch_ctx_t*)arg;
+    const dot_batch_t *b = &ctx->batch;
+    if (ctx->mode == 0) {
+        // наивный вариант: каждая пара - отдельный запуск параллельного цикла
+        for (long p = 0; p < b->count; p++) {
+            const double *x = b->x + p * b->stride, *y = b->y + p * b->stride;
+            double dot = 0.0;
+            #pragma omp parallel for reduction(+:dot)
+            for (long i = 0; i < b->length; i++) {
+                dot += x[i] * y[i];
+            }
+            ctx->out[p] = dot;
+        }
+    } else {
+        dot_batch(b, ctx->out, (dot_batch_strategy_t)(ctx->mode - 1));
+    }
+}
+
+// пакетный режим: перебор числа пар x длины пары, сравнение стратегий
+// время каждой стратегии - медиана повторений (BENCH_WARMUP / BENCH_REPS)
+int run_batch_sweep(void) {
+    long counts[] = {1, 16, 256, 4096, 65536, 1048576};
+    long lengths[] = {8, 64, 512, 4096, 65536, 1048576};
+    const long max_elements = 1L << 23;  // ограничение памяти: 2 вектора по 64 МБ
+    int ncounts = sizeof(counts) / sizeof(counts[0]);
+    int nlengths = sizeof(lengths) / sizeof(lengths[0]);
+    bench_config_t cfg = bench_config_from_env(1, 5);
+    
+    double *x = (double*)numa_alloc_first_touch(max_elements, sizeof(double));
+    double *y = (double*)numa_alloc_first_touch(max_elements, sizeof(double));
+    double *out = (double*)malloc(counts[ncounts - 1] * sizeof(double));
+    if (x == NULL || y == NULL || out == NULL) {
+        printf("ошибка выделения памяти!\n");
+        return 1;
+    }
+    fill_vectors(x, y, max_elements, rng_seed_from_env());
+    
+    printf("пакетное скалярное произведение: потоков %d, ядро %s, повторений %d\n",
+           omp_get_max_threads(), dot_kernel_name(), cfg.reps);
+    printf("%10s %10s %12s %12s %12s %12s  %s\n", "пар", "длина",
+           "parallel/пару", "по парам", "внутри пары", "авто", "выбор авто");
+    
+    for (int c = 0; c < ncounts; c++) {
+        for (int l = 0; l < nlengths; l++) {
+            if (counts[c] * lengths[l] > max_elements) continue;
+            batch_ctx_t ctx = {dot_batch_strided(x, y, counts[c], lengths[l], lengths[l]), out, 0};
+            double median[4];
+            for (int mode = 0; mode < 4; mode++) {
+                // наивный вариант на миллионах пар слишком долгий
+                if (mode == 0 && counts[c] > 4096) { median[mode] = 0.0; continue; }
+                ctx.mode = mode;
+                bench_result_t r;
+                bench_run("batch", batch_iteration, &ctx, cfg, &r);
+                median[mode] = r.median;
+            }
+            dot_batch_strategy_t chosen = dot_batch_choose(&ctx.batch, omp_get_max_threads());
+            printf("%10ld %10ld ", counts[c], lengths[l]);
+            if (median[0] > 0.0) printf("%12.6f ", median[0]);
+            else printf("%12s ", "-");
+            printf("%12.6f %12.6f %12.6f  %s\n", median[2], median[3], median[1],
+                   dot_batch_strategy_name(chosen));
+        }
+    }
+    
+    free(x);
+    free(y);
+    free(out);
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
+    // пакетный режим: ./dot_product batch
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) {
+        return run_batch_sweep();
+    }
+    
     // размер векторов можно передавать как аргумент командной строки
     int size = 1000000;  // значение по умолчанию - 1 миллион элементов
     if (argc > 1) {
         size = atoi(argv[1]);  // преобразуем строковый аргумент в число
     }
+    
+    // тип хранения для версии со смешанной точностью: double, float, bf16 или all (все три)
+    int first_precision = 0, last_precision = DOT_NUM_PRECISIONS - 1;
+    if (argc > 2 && strcmp(argv[2], "all") != 0) {
+        int p = dot_precision_from_name(argv[2]);
+        if (p < 0) {
+            printf("неизвестный тип хранения: %s (допустимо: double, float, bf16, all)\n", argv[2]);
+            return 1;
+        }
+        first_precision = last_precision = p;
+    }
 
     // выделяем память под два вектора типа double
-    double *vec1 = (double*)malloc(size * sizeof(double));
-    double *vec2 = (double*)malloc(size * sizeof(double));
+    // параллельное первое касание размещает страницы на узлах numa потоков, которые их читают
+    double *vec1 = (double*)numa_alloc_first_touch(size, sizeof(double));
+    double *vec2 = (double*)numa_alloc_first_touch(size, sizeof(double));
     
     if (vec1 == NULL || vec2 == NULL) {
         printf("ошибка выделения памяти!\n");
         return 1;
     }
 
-    // инициализируем генератор случайных чисел текущим временем
-    srand(time(NULL));
-    fill_vectors(vec1, vec2, size);  // заполняем векторы случайными значениями
+    // seed фиксирован (или задается через RNG_SEED), поэтому запуски воспроизводимы
+    uint64_t seed = rng_seed_from_env();
+    double fill_start = omp_get_wtime();
+    fill_vectors(vec1, vec2, size, seed);  // заполняем векторы случайными значениями
+    double fill_time = omp_get_wtime() - fill_start;
 
     printf("размер векторов: %d элементов\n", size);
+    printf("seed: %llu, генерация данных: %.4f секунд\n", (unsigned long long)seed, fill_time);
+    numa_print_binding();  // OMP_PLACES / OMP_PROC_BIND и размещение потоков по узлам
+    if (roofline_enabled()) roofline_print_machine(roofline_get());  // stream и пик fma этой машины
 
     // последовательная версия вычисления скалярного произведения
     double seq_dot = 0.0;  // переменная для хранения результата
@@ -51,12 +250,18 @@ int main(int argc, char *argv[]) {
 
     // параллельная версия с использованием редукции
     double red_dot = 0.0;  // переменная для хранения результата
+    loop_profile_t *profile = loop_profile_begin("reduction");  // NULL без LOOP_PROFILE=1
     double red_start = omp_get_wtime();  // засекаем время начала
 
-    // директива openmp для параллельного цикла с редукцией сложения
-    #pragma omp parallel for reduction(+:red_dot)
-    for (int i = 0; i < size; i++) {
-        red_dot += vec1[i] * vec2[i];  // каждый поток вычисляет свою часть суммы
+    // директива openmp для параллельной области с редукцией сложения
+    #pragma omp parallel reduction(+:red_dot)
+    {
+        loop_probe_t probe = loop_probe_start(profile);
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait", (int i = 0; i < size; i++), i,
+                         LOOP_CHUNK_STATIC,
+            red_dot += vec1[i] * vec2[i];  // каждый поток вычисляет свою часть суммы
+        );
+        loop_probe_finish(profile, &probe);  // барьер вместо неявного у omp for
     }
     // openmp автоматически суммирует результаты всех потоков
 
@@ -66,20 +271,37 @@ int main(int argc, char *argv[]) {
     printf("  скалярное произведение: %.2f\n", red_dot);
     printf("  время: %.4f секунд\n", red_time);
     printf("  ускорение: %.2fx\n", seq_time / red_time);  // вычисляем ускорение
+    // на элемент: чтение двух double (16 байт), умножение и сложение
+    roofline_kernel_t dot_kernel = {"dot", 2.0 * sizeof(double), 2.0, 0};
+    roofline_report(&dot_kernel, size, red_time);
+    loop_profile_report(profile);
 
     // параллельная версия без редукции с использованием критических секций
     double crit_dot = 0.0;  // переменная для хранения результата
+    int used_threads = 1;
+    numa_thread_bw_t *thread_bw = (numa_thread_bw_t*)calloc(omp_get_max_threads(), sizeof(numa_thread_bw_t));
     double crit_start = omp_get_wtime();  // засекаем время начала
 
     #pragma omp parallel
     {
         double local_dot = 0.0;  // локальная переменная для каждого потока
+        double thread_start = omp_get_wtime();
         
         // каждый поток вычисляет свою часть скалярного произведения
-        #pragma omp for
+        // schedule(static) совпадает с распределением при первом касании памяти
+        #pragma omp for schedule(static) nowait
         for (int i = 0; i < size; i++) {
             local_dot += vec1[i] * vec2[i];  // поток накапливает сумму в своей локальной переменной
         }
+        double thread_time = omp_get_wtime() - thread_start;
+        // число итераций потока - из разбиения schedule(static), а не счетчиком в цикле
+        long begin, end;
+        numa_static_range(size, &begin, &end);
+        if (thread_bw != NULL) {
+            numa_record(&thread_bw[omp_get_thread_num()], 2.0 * (end - begin) * sizeof(double), thread_time);
+        }
+        #pragma omp single nowait
+        used_threads = omp_get_num_threads();
         
         // суммируем результаты всех потоков через критические секции
         #pragma omp critical
@@ -94,11 +316,94 @@ int main(int argc, char *argv[]) {
     printf("  скалярное произведение: %.2f\n", crit_dot);
     printf("  время: %.4f секунд\n", crit_time);
     printf("  ускорение: %.2fx\n", seq_time / crit_time);  // вычисляем ускорение
+    numa_print_socket_bandwidth(thread_bw, used_threads);
+    free(thread_bw);
+
+    // воспроизводимые версии: эталон считается на 1 потоке и сравнивается побитово
+    // с результатом на каждом числе потоков от 2 до OMP_NUM_THREADS
+    int max_threads = omp_get_max_threads();
+    const char *repro_names[] = {"блоки + дерево", "блоки + дерево + компенсация"};
+    double repro_dots[2];
+    for (int compensated = 0; compensated <= 1; compensated++) {
+        omp_set_num_threads(1);
+        double repro_ref = repro_dot(vec1, vec2, size, compensated);
+        int mismatch_threads = 0;  // первое число потоков с другим результатом
+        for (int t = 2; t <= max_threads && mismatch_threads == 0; t++) {
+            omp_set_num_threads(t);
+            if (repro_dot(vec1, vec2, size, compensated) != repro_ref) mismatch_threads = t;
+        }
+        omp_set_num_threads(max_threads);
+        
+        double repro_start = omp_get_wtime();
+        double repro = repro_dot(vec1, vec2, size, compensated);
+        double repro_time = omp_get_wtime() - repro_start;
+        repro_dots[compensated] = repro;
+        
+        printf("\nвоспроизводимая версия (%s):\n", repro_names[compensated]);
+        printf("  скалярное произведение: %.2f\n", repro);
+        printf("  время: %.4f секунд\n", repro_time);
+        printf("  ускорение: %.2fx\n", seq_time / repro_time);
+        printf("  скорость относительно редукции: %.1f%%\n", 100.0 * red_time / repro_time);
+        if (mismatch_threads == 0 && repro == repro_ref) {
+            printf("  побитовое совпадение на 1..%d потоках: да\n", max_threads);
+        } else {
+            printf("  побитовое совпадение на 1..%d потоках: нет (%d потоков)\n", max_threads,
+                   mismatch_threads != 0 ? mismatch_threads : max_threads);
+        }
+    }
+
+    // смешанная точность: векторы хранятся в узком типе, накопление в double (bf16 - в float по блокам)
+    // точность оценивается относительно последовательной версии в double
+    printf("\nсмешанная точность: ядро %s\n", dot_kernel_name());
+    for (int p = first_precision; p <= last_precision; p++) {
+        dot_precision_t prec = (dot_precision_t)p;
+        size_t elem = dot_elem_size(prec);
+        void *x = numa_alloc_first_touch(size, elem);
+        void *y = numa_alloc_first_touch(size, elem);
+        if (x == NULL || y == NULL) {
+            printf("ошибка выделения памяти!\n");
+            return 1;
+        }
+        
+        // преобразование теми же блоками schedule(static), что и при первом касании
+        #pragma omp parallel
+        {
+            long begin, end;
+            numa_static_range(size, &begin, &end);
+            dot_convert((char*)x + begin * elem, vec1 + begin, end - begin, prec);
+            dot_convert((char*)y + begin * elem, vec2 + begin, end - begin, prec);
+        }
+        
+        double mixed_dot = 0.0;
+        double mixed_start = omp_get_wtime();
+        #pragma omp parallel reduction(+:mixed_dot)
+        {
+            long begin, end;
+            numa_static_range(size, &begin, &end);
+            mixed_dot = dot_typed((char*)x + begin * elem, (char*)y + begin * elem, end - begin, prec);
+        }
+        double mixed_time = omp_get_wtime() - mixed_start;
+        
+        printf("\nпараллельная версия (хранение %s):\n", dot_precision_name(prec));
+        printf("  скалярное произведение: %.2f\n", mixed_dot);
+        printf("  время: %.4f секунд\n", mixed_time);
+        printf("  ускорение: %.2fx (относительно редукции: %.2fx)\n",
+               seq_time / mixed_time, red_time / mixed_time);
+        printf("  пропускная способность: %.2f ГБ/с\n", 2.0 * size * elem / mixed_time / 1e9);
+        printf("  относительная ошибка: %.3e\n", fabs(mixed_dot - seq_dot) / fabs(seq_dot));
+        roofline_kernel_t mixed_kernel = {dot_precision_name(prec), 2.0 * elem, 2.0, 0};
+        roofline_report(&mixed_kernel, size, mixed_time);
+        
+        free(x);
+        free(y);
+    }
 
-    // проверка корректности результатов всех трех версий
+    // проверка корректности результатов всех версий
     printf("\nпроверка корректности:\n");
     printf("  разница (редукция): %.10f\n", fabs(seq_dot - red_dot));  // сравниваем с последовательной версией
     printf("  разница (крит.секции): %.10f\n", fabs(seq_dot - crit_dot));  // сравниваем с последовательной версией
+    printf("  разница (воспроизводимая): %.10f\n", fabs(seq_dot - repro_dots[0]));
+    printf("  разница (воспроизводимая + компенсация): %.10f\n", fabs(seq_dot - repro_dots[1]));
 
     free(vec1);  // освобождаем память, выделенную под первый вектор
     free(vec2);  // освобождаем память, выделенную под второй вектор
@@ -0,0 +1,10 @@
+#!/bin/bash
+echo "пакетный режим: число пар x длина пары для разного количества потоков"
+echo "===================================================================="
+
+# для каждого числа потоков печатается таблица времени стратегий (медианы)
+for threads in 1 2 4 8 16; do
+    echo "--- $threads потоков ---"
+    OMP_NUM_THREADS=$threads ./dot_product batch
+    echo ""
+done
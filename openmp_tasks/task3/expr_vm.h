@@ -0,0 +1,458 @@
+#ifndef EXPR_VM_H
+#define EXPR_VM_H
+
+// подынтегральная функция, заданная строкой: "sin(x)*exp(-x*x)"
+//
+// строка один раз разбирается (рекурсивный спуск) в дерево, константные
+// поддеревья сворачиваются, а дерево переводится в регистровый байт-код.
+// регистр - это блок из EXPR_BLOCK значений, и каждая инструкция обрабатывает
+// весь блок абсцисс простым циклом (сложение, умножение - векторизуются
+// компилятором, sin/cos/exp/log - через simd_math.h), поэтому разбор инструкции
+// и переход по switch стоят один раз на EXPR_BLOCK точек, а не на каждую точку
+//
+// синтаксис: числа, x, pi, e, + - * / ^ (степень, правоассоциативная),
+// унарный минус, скобки и функции sin cos tan exp log sqrt abs atan asin acos
+// sinh cosh tanh erf. целая степень до EXPR_MAX_POWI считается умножениями
+//
+// регистр 0 - сами абсциссы (только чтение), временные значения - в регистрах 1..,
+// которые выделяются стеком при обходе дерева (их число - глубина выражения)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "../../common/simd_math.h"
+
+#define EXPR_BLOCK 256       // точек на регистр
+#define EXPR_MAX_REGS 16     // временных регистров (16 x 256 x 8 байт = 32 КБ стека на поток)
+#define EXPR_MAX_NODES 256   // узлов дерева разбора
+#define EXPR_MAX_CODE 256    // инструкций
+#define EXPR_MAX_POWI 16     // x^n с целым |n| до этого значения - умножениями
+
+typedef enum {
+    EXPR_OP_CONST,                          // d = c
+    EXPR_OP_ADD, EXPR_OP_SUB, EXPR_OP_MUL, EXPR_OP_DIV, EXPR_OP_POW,  // d = a op b
+    EXPR_OP_ADDC, EXPR_OP_MULC, EXPR_OP_DIVC,  // d = a op c (a - c записывается как a + (-c))
+    EXPR_OP_CSUB, EXPR_OP_CDIV, EXPR_OP_CPOW,  // d = c op a
+    EXPR_OP_POWC,                           // d = a ^ c (нецелая или большая степень)
+    EXPR_OP_POWI,                           // d = a ^ n, n = (int)c
+    EXPR_OP_NEG,
+    // функции одного аргумента: d = fn(a)
+    EXPR_OP_SIN, EXPR_OP_COS, EXPR_OP_TAN, EXPR_OP_EXP, EXPR_OP_LOG, EXPR_OP_SQRT,
+    EXPR_OP_ABS, EXPR_OP_ATAN, EXPR_OP_ASIN, EXPR_OP_ACOS, EXPR_OP_SINH, EXPR_OP_COSH,
+    EXPR_OP_TANH, EXPR_OP_ERF
+} expr_op_t;
+
+typedef struct {
+    unsigned char op;
+    unsigned char dst, a, b;  // номера регистров
+    double c;                 // константа
+} expr_instr_t;
+
+typedef struct {
+    expr_instr_t code[EXPR_MAX_CODE];
+    int length;      // число инструкций
+    int registers;   // использовано временных регистров
+    int result;      // регистр с результатом (0 - выражение "x")
+} expr_program_t;
+
+// таблица функций: имя, инструкция и скалярная версия для свертки констант
+typedef struct {
+    const char *name;
+    expr_op_t op;
+    double (*fn)(double);
+} expr_function_t;
+
+static const expr_function_t expr_functions[] = {
+    {"sin", EXPR_OP_SIN, sin},    {"cos", EXPR_OP_COS, cos},    {"tan", EXPR_OP_TAN, tan},
+    {"exp", EXPR_OP_EXP, exp},    {"log", EXPR_OP_LOG, log},    {"sqrt", EXPR_OP_SQRT, sqrt},
+    {"abs", EXPR_OP_ABS, fabs},   {"atan", EXPR_OP_ATAN, atan}, {"asin", EXPR_OP_ASIN, asin},
+    {"acos", EXPR_OP_ACOS, acos}, {"sinh", EXPR_OP_SINH, sinh}, {"cosh", EXPR_OP_COSH, cosh},
+    {"tanh", EXPR_OP_TANH, tanh}, {"erf", EXPR_OP_ERF, erf},
+};
+#define EXPR_FUNCTION_COUNT ((int)(sizeof(expr_functions) / sizeof(expr_functions[0])))
+
+// узел дерева: константа, x, бинарная операция ('+', '-', '*', '/', '^') или функция
+typedef enum { EXPR_NODE_CONST, EXPR_NODE_X, EXPR_NODE_BINARY, EXPR_NODE_NEG, EXPR_NODE_CALL } expr_node_kind_t;
+
+typedef struct {
+    expr_node_kind_t kind;
+    char binop;
+    int fn;              // индекс в expr_functions
+    int left, right;
+    double value;
+} expr_node_t;
+
+typedef struct {
+    const char *src;
+    const char *pos;
+    expr_node_t nodes[EXPR_MAX_NODES];
+    int count;
+    expr_program_t *prog;
+    int top;             // занятые временные регистры
+    char error[128];
+} expr_compiler_t;
+
+static inline void expr_fail(expr_compiler_t *c, const char *msg) {
+    if (c->error[0] == '\0') {
+        snprintf(c->error, sizeof(c->error), "%s (позиция %d)", msg, (int)(c->pos - c->src) + 1);
+    }
+}
+
+static inline double expr_fold(char op, double l, double r) {
+    switch (op) {
+        case '+': return l + r;
+        case '-': return l - r;
+        case '*': return l * r;
+        case '/': return l / r;
+        default:  return pow(l, r);
+    }
+}
+
+static inline int expr_node(expr_compiler_t *c, expr_node_kind_t kind) {
+    if (c->count == EXPR_MAX_NODES) {
+        expr_fail(c, "слишком длинное выражение");
+        return 0;
+    }
+    expr_node_t *n = &c->nodes[c->count];
+    memset(n, 0, sizeof(*n));
+    n->kind = kind;
+    return c->count++;
+}
+
+static inline int expr_const_node(expr_compiler_t *c, double v) {
+    int n = expr_node(c, EXPR_NODE_CONST);
+    c->nodes[n].value = v;
+    return n;
+}
+
+// бинарный узел; два константных операнда сворачиваются сразу
+static inline int expr_binary_node(expr_compiler_t *c, char op, int l, int r) {
+    if (c->nodes[l].kind == EXPR_NODE_CONST && c->nodes[r].kind == EXPR_NODE_CONST) {
+        return expr_const_node(c, expr_fold(op, c->nodes[l].value, c->nodes[r].value));
+    }
+    int n = expr_node(c, EXPR_NODE_BINARY);
+    c->nodes[n].binop = op;
+    c->nodes[n].left = l;
+    c->nodes[n].right = r;
+    return n;
+}
+
+static inline void expr_skip_spaces(expr_compiler_t *c) {
+    while (isspace((unsigned char)*c->pos)) c->pos++;
+}
+
+static int expr_parse_sum(expr_compiler_t *c);
+
+// первичное выражение: число, имя, вызов функции или выражение в скобках
+static int expr_parse_primary(expr_compiler_t *c) {
+    expr_skip_spaces(c);
+    const char *p = c->pos;
+    if (isdigit((unsigned char)*p) || *p == '.') {
+        char *end;
+        double v = strtod(p, &end);
+        c->pos = end;
+        return expr_const_node(c, v);
+    }
+    if (*p == '(') {
+        c->pos++;
+        int n = expr_parse_sum(c);
+        expr_skip_spaces(c);
+        if (*c->pos != ')') {
+            expr_fail(c, "ожидается ')'");
+            return n;
+        }
+        c->pos++;
+        return n;
+    }
+    if (isalpha((unsigned char)*p)) {
+        const char *start = p;
+        while (isalnum((unsigned char)*p) || *p == '_') p++;
+        int len = (int)(p - start);
+        c->pos = p;
+        if (len == 1 && start[0] == 'x') return expr_node(c, EXPR_NODE_X);
+        if (len == 2 && strncmp(start, "pi", 2) == 0) return expr_const_node(c, M_PI);
+        if (len == 1 && start[0] == 'e') return expr_const_node(c, M_E);
+        for (int f = 0; f < EXPR_FUNCTION_COUNT; f++) {
+            if ((int)strlen(expr_functions[f].name) != len || strncmp(expr_functions[f].name, start, len) != 0) {
+                continue;
+            }
+            expr_skip_spaces(c);
+            if (*c->pos != '(') {
+                expr_fail(c, "ожидается '(' после имени функции");
+                return 0;
+            }
+            int arg = expr_parse_primary(c);  // скобки разбираются как первичное выражение
+            if (c->nodes[arg].kind == EXPR_NODE_CONST) {
+                return expr_const_node(c, expr_functions[f].fn(c->nodes[arg].value));
+            }
+            int n = expr_node(c, EXPR_NODE_CALL);
+            c->nodes[n].fn = f;
+            c->nodes[n].left = arg;
+            return n;
+        }
+        c->pos = start;
+        expr_fail(c, "неизвестное имя");
+        return 0;
+    }
+    expr_fail(c, *p == '\0' ? "неожиданный конец выражения" : "неожиданный символ");
+    return 0;
+}
+
+// степень правоассоциативна и связывает сильнее унарного минуса: -x^2 = -(x^2)
+static int expr_parse_unary(expr_compiler_t *c);
+
+static int expr_parse_power(expr_compiler_t *c) {
+    int base = expr_parse_primary(c);
+    expr_skip_spaces(c);
+    if (*c->pos == '^') {
+        c->pos++;
+        int exponent = expr_parse_unary(c);
+        return expr_binary_node(c, '^', base, exponent);
+    }
+    return base;
+}
+
+static int expr_parse_unary(expr_compiler_t *c) {
+    expr_skip_spaces(c);
+    if (*c->pos == '-' || *c->pos == '+') {
+        char sign = *c->pos++;
+        int arg = expr_parse_unary(c);
+        if (sign == '+') return arg;
+        if (c->nodes[arg].kind == EXPR_NODE_CONST) return expr_const_node(c, -c->nodes[arg].value);
+        int n = expr_node(c, EXPR_NODE_NEG);
+        c->nodes[n].left = arg;
+        return n;
+    }
+    return expr_parse_power(c);
+}
+
+static int expr_parse_product(expr_compiler_t *c) {
+    int left = expr_parse_unary(c);
+    for (;;) {
+        expr_skip_spaces(c);
+        char op = *c->pos;
+        if (op != '*' && op != '/') return left;
+        c->pos++;
+        left = expr_binary_node(c, op, left, expr_parse_unary(c));
+    }
+}
+
+static int expr_parse_sum(expr_compiler_t *c) {
+    int left = expr_parse_product(c);
+    for (;;) {
+        expr_skip_spaces(c);
+        char op = *c->pos;
+        if (op != '+' && op != '-') return left;
+        c->pos++;
+        left = expr_binary_node(c, op, left, expr_parse_product(c));
+    }
+}
+
+static inline int expr_emit(expr_compiler_t *c, expr_op_t op, int dst, int a, int b, double k) {
+    expr_program_t *p = c->prog;
+    if (p->length == EXPR_MAX_CODE) {
+        expr_fail(c, "слишком много инструкций");
+        return dst;
+    }
+    expr_instr_t *in = &p->code[p->length++];
+    in->op = (unsigned char)op;
+    in->dst = (unsigned char)dst;
+    in->a = (unsigned char)a;
+    in->b = (unsigned char)b;
+    in->c = k;
+    return dst;
+}
+
+static inline int expr_alloc(expr_compiler_t *c) {
+    if (c->top == EXPR_MAX_REGS) {
+        expr_fail(c, "выражение слишком глубокое");
+        return c->top;
+    }
+    c->top++;
+    if (c->top > c->prog->registers) c->prog->registers = c->top;
+    return c->top;
+}
+
+// регистр результата: свой временный регистр операнда или новый (регистр x только читается)
+static inline int expr_target(expr_compiler_t *c, int reg) {
+    return reg > 0 ? reg : expr_alloc(c);
+}
+
+// генерация кода узла; возвращает регистр с его значением
+static int expr_gen(expr_compiler_t *c, int node) {
+    const expr_node_t *n = &c->nodes[node];
+    switch (n->kind) {
+        case EXPR_NODE_X:
+            return 0;
+        case EXPR_NODE_CONST:
+            return expr_emit(c, EXPR_OP_CONST, expr_alloc(c), 0, 0, n->value);
+        case EXPR_NODE_NEG: {
+            int a = expr_gen(c, n->left);
+            return expr_emit(c, EXPR_OP_NEG, expr_target(c, a), a, 0, 0.0);
+        }
+        case EXPR_NODE_CALL: {
+            int a = expr_gen(c, n->left);
+            return expr_emit(c, expr_functions[n->fn].op, expr_target(c, a), a, 0, 0.0);
+        }
+        default:
+            break;
+    }
+
+    const expr_node_t *l = &c->nodes[n->left], *r = &c->nodes[n->right];
+    // один операнд - константа: инструкция с непосредственным значением
+    if (r->kind == EXPR_NODE_CONST) {
+        int a = expr_gen(c, n->left);
+        int d = expr_target(c, a);
+        double k = r->value;
+        switch (n->binop) {
+            case '+': return expr_emit(c, EXPR_OP_ADDC, d, a, 0, k);
+            case '-': return expr_emit(c, EXPR_OP_ADDC, d, a, 0, -k);
+            case '*': return expr_emit(c, EXPR_OP_MULC, d, a, 0, k);
+            case '/': return expr_emit(c, EXPR_OP_DIVC, d, a, 0, k);
+            default:
+                if (k == rint(k) && fabs(k) <= EXPR_MAX_POWI) return expr_emit(c, EXPR_OP_POWI, d, a, 0, k);
+                return expr_emit(c, EXPR_OP_POWC, d, a, 0, k);
+        }
+    }
+    if (l->kind == EXPR_NODE_CONST) {
+        int b = expr_gen(c, n->right);
+        int d = expr_target(c, b);
+        double k = l->value;
+        switch (n->binop) {
+            case '+': return expr_emit(c, EXPR_OP_ADDC, d, b, 0, k);
+            case '-': return expr_emit(c, EXPR_OP_CSUB, d, b, 0, k);
+            case '*': return expr_emit(c, EXPR_OP_MULC, d, b, 0, k);
+            case '/': return expr_emit(c, EXPR_OP_CDIV, d, b, 0, k);
+            default:  return expr_emit(c, EXPR_OP_CPOW, d, b, 0, k);
+        }
+    }
+
+    int a = expr_gen(c, n->left);
+    int b = expr_gen(c, n->right);
+    // результат - в регистр левого операнда, если он временный, иначе правого;
+    // временные регистры выделяются стеком, поэтому освобождается всегда верхний
+    int d = a > 0 ? a : expr_target(c, b);
+    if (b > 0 && d != b) c->top--;
+    expr_op_t op = n->binop == '+' ? EXPR_OP_ADD : n->binop == '-' ? EXPR_OP_SUB :
+                   n->binop == '*' ? EXPR_OP_MUL : n->binop == '/' ? EXPR_OP_DIV : EXPR_OP_POW;
+    return expr_emit(c, op, d, a, b, 0.0);
+}
+
+// разбор и компиляция; 0 - успех, иначе текст ошибки в error (размер не меньше 128)
+static inline int expr_compile(const char *src, expr_program_t *prog, char *error) {
+    expr_compiler_t *c = (expr_compiler_t *)calloc(1, sizeof(expr_compiler_t));
+    memset(prog, 0, sizeof(*prog));
+    if (c == NULL) {
+        snprintf(error, 128, "не хватает памяти под разбор выражения");
+        return 1;
+    }
+    c->src = src;
+    c->pos = src;
+    c->prog = prog;
+
+    int root = expr_parse_sum(c);
+    expr_skip_spaces(c);
+    if (*c->pos != '\0') expr_fail(c, "лишние символы в конце");
+    if (c->error[0] == '\0') prog->result = expr_gen(c, root);
+
+    int status = c->error[0] != '\0';
+    if (status) strcpy(error, c->error);
+    free(c);
+    return status;
+}
+
+// вычисление программы на n <= EXPR_BLOCK точках
+static inline void expr_eval_block(const expr_program_t *p, const double *x, double *out, int n) {
+    double regs[EXPR_MAX_REGS][EXPR_BLOCK];
+    double *R[EXPR_MAX_REGS + 1];
+    R[0] = (double *)x;  // в регистр 0 не пишет ни одна инструкция
+    for (int r = 1; r <= p->registers; r++) R[r] = regs[r - 1];
+
+    for (int pc = 0; pc < p->length; pc++) {
+        const expr_instr_t *in = &p->code[pc];
+        double *d = R[in->dst];
+        const double *a = R[in->a], *b = R[in->b];
+        const double k = in->c;
+        switch ((expr_op_t)in->op) {
+            case EXPR_OP_CONST: for (int i = 0; i < n; i++) d[i] = k; break;
+            case EXPR_OP_ADD:   for (int i = 0; i < n; i++) d[i] = a[i] + b[i]; break;
+            case EXPR_OP_SUB:   for (int i = 0; i < n; i++) d[i] = a[i] - b[i]; break;
+            case EXPR_OP_MUL:   for (int i = 0; i < n; i++) d[i] = a[i] * b[i]; break;
+            case EXPR_OP_DIV:   for (int i = 0; i < n; i++) d[i] = a[i] / b[i]; break;
+            case EXPR_OP_POW:   for (int i = 0; i < n; i++) d[i] = pow(a[i], b[i]); break;
+            case EXPR_OP_ADDC:  for (int i = 0; i < n; i++) d[i] = a[i] + k; break;
+            case EXPR_OP_MULC:  for (int i = 0; i < n; i++) d[i] = a[i] * k; break;
+            case EXPR_OP_DIVC:  for (int i = 0; i < n; i++) d[i] = a[i] / k; break;
+            case EXPR_OP_CSUB:  for (int i = 0; i < n; i++) d[i] = k - a[i]; break;
+            case EXPR_OP_CDIV:  for (int i = 0; i < n; i++) d[i] = k / a[i]; break;
+            case EXPR_OP_CPOW:  for (int i = 0; i < n; i++) d[i] = pow(k, a[i]); break;
+            case EXPR_OP_POWC:  for (int i = 0; i < n; i++) d[i] = pow(a[i], k); break;
+            case EXPR_OP_POWI: {
+                // возведение в квадрат по битам показателя, затем 1/x для отрицательного
+                int e = (int)k, m = abs(e);
+                double tmp[EXPR_BLOCK];
+                for (int i = 0; i < n; i++) tmp[i] = a[i];
+                for (int i = 0; i < n; i++) d[i] = 1.0;
+                for (; m > 0; m >>= 1) {
+                    if (m & 1) for (int i = 0; i < n; i++) d[i] *= tmp[i];
+                    if (m > 1) for (int i = 0; i < n; i++) tmp[i] *= tmp[i];
+                }
+                if (e < 0) for (int i = 0; i < n; i++) d[i] = 1.0 / d[i];
+                break;
+            }
+            case EXPR_OP_NEG:   for (int i = 0; i < n; i++) d[i] = -a[i]; break;
+            case EXPR_OP_SIN:   simd_sin(a, d, n, SIMD_MATH_PRECISE); break;
+            case EXPR_OP_COS:   simd_cos(a, d, n, SIMD_MATH_PRECISE); break;
+            case EXPR_OP_EXP:   simd_exp(a, d, n, SIMD_MATH_PRECISE); break;
+            case EXPR_OP_LOG:   simd_log(a, d, n, SIMD_MATH_PRECISE); break;
+            case EXPR_OP_SQRT:  for (int i = 0; i < n; i++) d[i] = sqrt(a[i]); break;
+            case EXPR_OP_ABS:   for (int i = 0; i < n; i++) d[i] = fabs(a[i]); break;
+            case EXPR_OP_TAN:   for (int i = 0; i < n; i++) d[i] = tan(a[i]); break;
+            case EXPR_OP_ATAN:  for (int i = 0; i < n; i++) d[i] = atan(a[i]); break;
+            case EXPR_OP_ASIN:  for (int i = 0; i < n; i++) d[i] = asin(a[i]); break;
+            case EXPR_OP_ACOS:  for (int i = 0; i < n; i++) d[i] = acos(a[i]); break;
+            case EXPR_OP_SINH:  for (int i = 0; i < n; i++) d[i] = sinh(a[i]); break;
+            case EXPR_OP_COSH:  for (int i = 0; i < n; i++) d[i] = cosh(a[i]); break;
+            case EXPR_OP_TANH:  for (int i = 0; i < n; i++) d[i] = tanh(a[i]); break;
+            case EXPR_OP_ERF:   for (int i = 0; i < n; i++) d[i] = erf(a[i]); break;
+        }
+    }
+    if (out != R[p->result]) memcpy(out, R[p->result], n * sizeof(double));
+}
+
+// вычисление на произвольном числе точек (блоками по EXPR_BLOCK)
+static inline void expr_eval(const expr_program_t *p, const double *x, double *out, long n) {
+    for (long lo = 0; lo < n; lo += EXPR_BLOCK) {
+        int len = (n - lo < EXPR_BLOCK) ? (int)(n - lo) : EXPR_BLOCK;
+        expr_eval_block(p, x + lo, out + lo, len);
+    }
+}
+
+// пачка значений для адаптивного интегратора (gk_batch_fn_t), ctx - expr_program_t
+static inline void expr_batch(const double *x, double *fx, int n, void *ctx) {
+    expr_eval((const expr_program_t *)ctx, x, fx, n);
+}
+
+// листинг байт-кода (r0 - x)
+static inline void expr_print(const expr_program_t *p, FILE *out) {
+    static const char *names[] = {
+        "const", "add", "sub", "mul", "div", "pow", "addc", "mulc", "divc", "csub", "cdiv", "cpow",
+        "powc", "powi", "neg", "sin", "cos", "tan", "exp", "log", "sqrt", "abs", "atan", "asin",
+        "acos", "sinh", "cosh", "tanh", "erf"
+    };
+    for (int pc = 0; pc < p->length; pc++) {
+        const expr_instr_t *in = &p->code[pc];
+        if (in->op == EXPR_OP_CONST) {
+            fprintf(out, "    %-5s r%d, %.17g\n", names[in->op], in->dst, in->c);
+            continue;
+        }
+        fprintf(out, "    %-5s r%d, r%d", names[in->op], in->dst, in->a);
+        if (in->op >= EXPR_OP_ADD && in->op <= EXPR_OP_POW) fprintf(out, ", r%d", in->b);
+        if (in->op >= EXPR_OP_ADDC && in->op <= EXPR_OP_POWI) fprintf(out, ", %.17g", in->c);
+        fprintf(out, "\n");
+    }
+}
+
+#endif // EXPR_VM_H
@@ -2,42 +2,453 @@
 #include <stdlib.h>
 #include <omp.h>
 #include <math.h>
+#include <string.h>
+#include "../../common/roofline.h"
+#include "../../common/gauss_kronrod.h"
+#include "../../common/simd_math.h"
+#include "../../common/philox_rng.h"
+#include "../../common/loop_profile.h"
+#include "../../common/romberg.h"
+#include "integrands.h"
+#include "expr_vm.h"
+#include "qmc_integrands.h"
 
-// подынтегральная функция - можно менять для разных экспериментов
-double f(double x) {
-    return sin(x);  // ∫sin(x)dx от 0 до π = 2
-    // return x * x; // ∫x²dx от 0 до 1 = 1/3
-    // return exp(x); // ∫e^xdx от 0 до 1 = e - 1 ≈ 1.718
+// метод средних прямоугольников через векторизованную функцию реестра (sin, cos, exp, log):
+// точки обрабатываются блоками по SIMD_BLOCK (вычисление абсцисс, simd-функция, сумма);
+// profile - профиль дисбаланса по потокам (итерация - блок) или NULL
+#define SIMD_BLOCK 256
+double midpoint_simd(const integrand_t *it, double a, double h, int n, simd_math_accuracy_t acc,
+                     loop_profile_t *profile) {
+    double sum = 0.0;
+    #pragma omp parallel reduction(+:sum)
+    {
+        double xs[SIMD_BLOCK], ys[SIMD_BLOCK];
+        loop_probe_t probe = loop_probe_start(profile);
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait",
+                         (int lo = 0; lo < n; lo += SIMD_BLOCK), lo / SIMD_BLOCK, LOOP_CHUNK_STATIC,
+            int len = (n - lo < SIMD_BLOCK) ? n - lo : SIMD_BLOCK;
+            for (int k = 0; k < len; k++) {
+                xs[k] = a + (lo + k + 0.5) * h;
+            }
+            it->simd(xs, ys, len, acc);
+            double block = 0.0;
+            for (int k = 0; k < len; k++) {
+                block += ys[k];
+            }
+            sum += block;
+        );
+        loop_probe_finish(profile, &probe);  // барьер вместо неявного у omp for
+    }
+    return sum * h;
+}
+
+// метод средних прямоугольников для выражения, скомпилированного в байт-код:
+// одна инструкция интерпретатора обрабатывает блок из EXPR_BLOCK абсцисс
+double midpoint_expr(const expr_program_t *prog, double a, double h, int n) {
+    double sum = 0.0;
+    simd_math_kernel_name();  // выбор ядра simd_math до входа в параллельную область
+    #pragma omp parallel reduction(+:sum)
+    {
+        double xs[EXPR_BLOCK], ys[EXPR_BLOCK];
+        #pragma omp for schedule(static)
+        for (int lo = 0; lo < n; lo += EXPR_BLOCK) {
+            int len = (n - lo < EXPR_BLOCK) ? n - lo : EXPR_BLOCK;
+            for (int k = 0; k < len; k++) {
+                xs[k] = a + (lo + k + 0.5) * h;
+            }
+            expr_eval_block(prog, xs, ys, len);
+            double block = 0.0;
+            for (int k = 0; k < len; k++) {
+                block += ys[k];
+            }
+            sum += block;
+        }
+    }
+    return sum * h;
+}
+
+// функция реестра с тем же текстом выражения (пробелы не учитываются); NULL - нет такой
+const integrand_t *integrand_by_source(const char *src) {
+    for (int i = 0; i < INTEGRAND_COUNT; i++) {
+        const char *p = src, *q = integrands[i].source;
+        for (;;) {
+            while (*p == ' ') p++;
+            while (*q == ' ') q++;
+            if (*p != *q) break;
+            if (*p == '\0') return &integrands[i];
+            p++;
+            q++;
+        }
+    }
+    return NULL;
+}
+
+// интеграл выражения, заданного строкой (--expr): метод прямоугольников и адаптивный
+// метод через интерпретатор байт-кода; точное значение неизвестно, поэтому эталоном
+// служит адаптивный метод с точностью tol
+int run_expression(const char *src, double a, double b, int n, double tol) {
+    expr_program_t prog;
+    char error[128];
+    if (expr_compile(src, &prog, error) != 0) {
+        fprintf(stderr, "ошибка в выражении \"%s\": %s\n", src, error);
+        return 1;
+    }
+    double h = (b - a) / n;
+
+    printf("вычисление интеграла ∫(%s) dx от %.2f до %.2f\n", src, a, b);
+    printf("количество разбиений: %d\n", n);
+    printf("байт-код: %d инструкций, %d временных регистров по %d точек\n",
+           prog.length, prog.registers, EXPR_BLOCK);
+    expr_print(&prog, stdout);
+
+    double gk_start = omp_get_wtime();
+    gk_result_t gk = gk_integrate(expr_batch, &prog, a, b, tol, tol, 100000000L);
+    double gk_time = omp_get_wtime() - gk_start;
+
+    printf("\nадаптивная версия (гаусс-кронрод g7-k15, байт-код, точность %.1e):\n", tol);
+    printf("  приближенное значение: %.10f (оценка погрешности: %.2e)%s\n", gk.result, gk.error,
+           gk_status_note(&gk));
+    printf("  вычислений функции: %ld, отрезков: %ld\n", gk.evaluations, gk.intervals);
+    printf("  время: %.6f секунд\n", gk_time);
+
+    double vm_start = omp_get_wtime();
+    double vm_integral = midpoint_expr(&prog, a, h, n);
+    double vm_time = omp_get_wtime() - vm_start;
+
+    printf("\nпараллельная версия (редукция, байт-код):\n");
+    printf("  приближенное значение: %.10f\n", vm_integral);
+    printf("  отличие от адаптивной версии: %.10f\n", fabs(vm_integral - gk.result));
+    printf("  время: %.4f секунд (%.1f млн точек/с)\n", vm_time, n / vm_time / 1e6);
+
+    // то же выражение есть в реестре - сравнение со скомпилированным циклом
+    const integrand_t *fn = integrand_by_source(src);
+    if (fn != NULL) {
+        double red_start = omp_get_wtime();
+        double red_integral = fn->midpoint_reduction(a, h, n);
+        double red_time = omp_get_wtime() - red_start;
+        printf("\nскомпилированная версия (функция реестра %s):\n", fn->name);
+        printf("  приближенное значение: %.10f\n", red_integral);
+        printf("  время: %.4f секунд (%.1f млн точек/с)\n", red_time, n / red_time / 1e6);
+        printf("  байт-код относительно скомпилированной версии: %.2fx\n", red_time / vm_time);
+    } else {
+        printf("  скомпилированной версии нет: сравнение по функциям реестра - ./integral --func all\n");
+    }
+    return 0;
+}
+
+// метод прямоугольников функции реестра для ромберга: специализированный цикл с редукцией
+double romberg_registry_midpoint(double a, double h, long n, void *ctx) {
+    return ((const integrand_t *)ctx)->midpoint_reduction(a, h, (int)n);
+}
+
+// метод ромберга (--romberg): уровни трапеций с удвоением числа отрезков используют
+// все прежние точки, каждый уровень - одна параллельная редукция по новым точкам;
+// max_n ограничивает число отрезков последнего уровня
+void run_romberg(const integrand_t *fn, double a, double b, double exact_value, int max_n, double tol) {
+    int max_levels = 1;
+    while (max_levels < ROMBERG_MAX_LEVELS && (1L << max_levels) <= max_n) max_levels++;
+
+    double start = omp_get_wtime();
+    romberg_result_t r = romberg_integrate(romberg_registry_midpoint, (void *)fn, a, b,
+                                           fn->f(a) + fn->f(b), tol, tol, 4, max_levels, omp_get_wtime);
+    double total_time = omp_get_wtime() - start;
+
+    printf("\nметод ромберга (вложенные трапеции + экстраполяция ричардсона, точность %.1e):\n", tol);
+    printf("  уровень     отрезков           трапеции            ромберг  погрешность      время с\n");
+    long sweep_evaluations = 2;  // те же уровни, посчитанные каждый с нуля
+    for (int k = 0; k < r.levels; k++) {
+        printf("  %7d %12ld %18.12f %18.12f %12.2e %12.6f\n", k, 1L << k, r.trapezoid[k], r.diagonal[k],
+               fabs(r.diagonal[k] - exact_value), r.level_time[k]);
+        if (k > 0) sweep_evaluations += (1L << k) + 1;
+    }
+    long finest = 1L << (r.levels - 1);
+    printf("  приближенное значение: %.10f\n", r.result);
+    printf("  погрешность: %.10f (оценка: %.2e)%s\n", fabs(r.result - exact_value), r.error,
+           r.converged ? "" : " - точность не достигнута");
+    printf("  вычислений функции: %ld (самый мелкий уровень: %ld, все уровни с нуля: %ld)\n",
+           r.evaluations, finest + 1, sweep_evaluations);
+
+    // для сравнения: один самый мелкий уровень, посчитанный с нуля (столько же точек)
+    start = omp_get_wtime();
+    fn->midpoint_reduction(a, (b - a) / finest, (int)finest);
+    double finest_time = omp_get_wtime() - start;
+    printf("  время: %.6f секунд (один уровень из %ld точек с нуля: %.6f секунд)\n",
+           total_time, finest, finest_time);
+}
+
+// строка отчета квази-монте-карло
+void print_qmc(const char *title, qmc_result_t r, double exact, double time, double seq_time) {
+    printf("\n%s:\n", title);
+    printf("  приближенное значение: %.10f\n", r.estimate);
+    printf("  погрешность: %.10f (оценка по сдвигам: %.2e)\n", fabs(r.estimate - exact), r.error);
+    printf("  время: %.4f секунд\n", time);
+    if (seq_time > 0.0) printf("  ускорение: %.2fx\n", seq_time / time);
+}
+
+// многомерный интеграл по [0, 1]^dim квази-монте-карло (--qmc <dim>):
+// тот же отчет, что у метода прямоугольников - последовательно, редукция, критические секции
+int run_qmc(const char *func_name, int dim, long points, qmc_sequence_t seq, int shifts) {
+    const qmc_integrand_t *fn = qmc_integrand_find(func_name);
+    if (fn == NULL) {
+        fprintf(stderr, "неизвестная многомерная функция: %s (есть:", func_name);
+        for (int i = 0; i < QMC_INTEGRAND_COUNT; i++) fprintf(stderr, " %s", qmc_integrands[i].name);
+        fprintf(stderr, ")\n");
+        return 1;
+    }
+    if (dim < 1 || dim > QMC_MAX_DIM || shifts < 2 || shifts > QMC_MAX_SHIFTS) {
+        fprintf(stderr, "размерность от 1 до %d, сдвигов от 2 до %d\n", QMC_MAX_DIM, QMC_MAX_SHIFTS);
+        return 1;
+    }
+    qmc_config_t cfg = {seq, dim, points, shifts, rng_seed_from_env()};
+    double exact_value = fn->exact(dim);
+
+    printf("вычисление интеграла по [0,1]^%d: %s (квази-монте-карло)\n", dim, fn->label);
+    printf("последовательность: %s, точек на сдвиг: %ld, случайных сдвигов: %d\n",
+           qmc_sequence_name(seq), points, shifts);
+    printf("точное значение: %.10f\n", exact_value);
+
+    double start = omp_get_wtime();
+    qmc_result_t seq_res = qmc_integrate(&cfg, fn->batch, NULL, QMC_SEQUENTIAL);
+    double seq_time = omp_get_wtime() - start;
+    print_qmc("последовательная версия", seq_res, exact_value, seq_time, 0.0);
+
+    start = omp_get_wtime();
+    qmc_result_t red = qmc_integrate(&cfg, fn->batch, NULL, QMC_REDUCTION);
+    double red_time = omp_get_wtime() - start;
+    print_qmc("параллельная версия (редукция)", red, exact_value, red_time, seq_time);
+
+    start = omp_get_wtime();
+    qmc_result_t crit = qmc_integrate(&cfg, fn->batch, NULL, QMC_CRITICAL);
+    double crit_time = omp_get_wtime() - start;
+    print_qmc("параллельная версия (критические секции)", crit, exact_value, crit_time, seq_time);
+
+    // другая последовательность на тех же точках и сдвигах - для сравнения точности
+    qmc_config_t other = cfg;
+    other.sequence = seq == QMC_SOBOL ? QMC_HALTON : QMC_SOBOL;
+    start = omp_get_wtime();
+    qmc_result_t alt = qmc_integrate(&other, fn->batch, NULL, QMC_REDUCTION);
+    double alt_time = omp_get_wtime() - start;
+    char title[160];
+    snprintf(title, sizeof(title), "параллельная версия (редукция, последовательность %s)",
+             qmc_sequence_name(other.sequence));
+    print_qmc(title, alt, exact_value, alt_time, seq_time);
+
+    printf("\nсравнение методов:\n");
+    printf("  разница (редукция): %.10f\n", fabs(seq_res.estimate - red.estimate));
+    printf("  разница (крит.секции): %.10f\n", fabs(seq_res.estimate - crit.estimate));
+    return 0;
+}
+
+// сравнение libm и векторизованных функций на count случайных аргументах:
+// время на один вызов и максимальная погрешность в ulp относительно libm
+void compare_math_functions(long count) {
+    const char *names[4] = {"sin", "cos", "exp", "log"};
+    double *x = (double*)malloc(count * sizeof(double));
+    double *ref = (double*)malloc(count * sizeof(double));
+    double *y = (double*)calloc(count, sizeof(double));  // страницы касаются до замеров
+    if (x == NULL || ref == NULL || y == NULL) {
+        printf("\nматематические функции: пропущено, не хватает памяти под %ld аргументов\n", count);
+        free(x);
+        free(ref);
+        free(y);
+        return;
+    }
+    uint64_t seed = rng_seed_from_env();
+
+    printf("\nматематические функции (%ld аргументов, 1 поток, ядро %s):\n", count, simd_math_kernel_name());
+    printf("  %-4s %12s %14s %10s %14s %10s\n", "", "libm нс", "точная нс", "ulp", "быстрая нс", "ulp");
+    for (int fn = 0; fn < 4; fn++) {
+        // области аргументов: sin/cos [-100, 100], exp [-700, 700], log - порядки 1e-300..1e300
+        if (fn < 2) rng_fill_range(x, count, seed, 10 + fn, 0, -100.0, 100.0);
+        else if (fn == 2) rng_fill_range(x, count, seed, 12, 0, -700.0, 700.0);
+        else {
+            rng_fill_range(x, count, seed, 13, 0, -690.0, 690.0);
+            for (long i = 0; i < count; i++) x[i] = exp(x[i]);
+        }
+
+        double start, libm_time = 1e30;
+        for (int rep = 0; rep < 3; rep++) {  // лучшее из 3 запусков, как и для simd-версий
+            start = omp_get_wtime();
+            for (long i = 0; i < count; i++) {
+                ref[i] = fn == 0 ? sin(x[i]) : fn == 1 ? cos(x[i]) : fn == 2 ? exp(x[i]) : log(x[i]);
+            }
+            double t = omp_get_wtime() - start;
+            if (t < libm_time) libm_time = t;
+        }
+
+        // у sin и cos один уровень точности - быстрый вариант не замеряется
+        int tiers = fn < 2 ? 1 : 2;
+        double times[2], ulps[2];
+        for (int acc = 0; acc < tiers; acc++) {
+            times[acc] = 1e30;
+            for (int rep = 0; rep < 3; rep++) {
+                start = omp_get_wtime();
+                switch (fn) {
+                    case 0: simd_sin(x, y, count, (simd_math_accuracy_t)acc); break;
+                    case 1: simd_cos(x, y, count, (simd_math_accuracy_t)acc); break;
+                    case 2: simd_exp(x, y, count, (simd_math_accuracy_t)acc); break;
+                    default: simd_log(x, y, count, (simd_math_accuracy_t)acc); break;
+                }
+                double t = omp_get_wtime() - start;
+                if (t < times[acc]) times[acc] = t;
+            }
+            ulps[acc] = 0.0;
+            for (long i = 0; i < count; i++) {
+                double u = simd_math_ulp_error(y[i], ref[i]);
+                if (u > ulps[acc]) ulps[acc] = u;
+            }
+        }
+        printf("  %-4s %12.2f %14.2f %10.1f", names[fn], 1e9 * libm_time / count,
+               1e9 * times[0] / count, ulps[0]);
+        if (tiers == 1) printf(" %14s %10s\n", "-", "-");
+        else printf(" %14.2f %10.1f\n", 1e9 * times[1] / count, ulps[1]);
+    }
+    free(x);
+    free(ref);
+    free(y);
+}
+
+// список функций реестра (--list)
+void list_integrands(void) {
+    printf("функции реестра (--func <имя>, --func all - все по очереди):\n");
+    for (int i = 0; i < INTEGRAND_COUNT; i++) {
+        const integrand_t *it = &integrands[i];
+        printf("  %-8s %-18s [%6.3f, %6.3f]  точное значение %.10f%s\n", it->name, it->label,
+               it->a, it->b, integrand_exact(it, it->a, it->b), it->simd != NULL ? "  (simd)" : "");
+    }
+}
+
+// сводная таблица по всем функциям реестра: редукция и адаптивный метод
+void run_sweep(int n, double tol) {
+    printf("все функции реестра: %d разбиений, точность адаптивного метода %.1e, %d потоков\n",
+           n, tol, omp_get_max_threads());
+    printf("  имя      функция              редукция с  погрешность  адаптивн. с  погрешность вычислений  байт-код с  отношение\n");
+    for (int i = 0; i < INTEGRAND_COUNT; i++) {
+        const integrand_t *it = &integrands[i];
+        double exact = integrand_exact(it, it->a, it->b);
+        double h = (it->b - it->a) / n;
+
+        double start = omp_get_wtime();
+        double red = it->midpoint_reduction(it->a, h, n);
+        double red_time = omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        gk_result_t gk = gk_integrate(it->batch, NULL, it->a, it->b, tol, tol, 100000000L);
+        double gk_time = omp_get_wtime() - start;
+
+        // то же выражение через интерпретатор байт-кода
+        expr_program_t prog;
+        char error[128];
+        double vm_time = 0.0;
+        if (expr_compile(it->source, &prog, error) == 0) {
+            start = omp_get_wtime();
+            midpoint_expr(&prog, it->a, h, n);
+            vm_time = omp_get_wtime() - start;
+        }
+
+        printf("  %-8s %-18s %12.4f %12.2e %12.6f %12.2e %10ld", it->name, it->label,
+               red_time, fabs(red - exact), gk_time, fabs(gk.result - exact), gk.evaluations);
+        // байт-код не скомпилирован - вместо времени и отношения прочерки
+        if (vm_time > 0.0) printf(" %11.4f %9.2fx", vm_time, red_time / vm_time);
+        else printf(" %11s %10s", "-", "-");
+        printf("%s\n", gk_status_note(&gk));
+    }
 }
 
 int main(int argc, char *argv[]) {
-    // параметры интегрирования
-    double a = 0.0;          // нижний предел интегрирования
-    double b = M_PI;         // верхний предел интегрирования (π)
     int n = 100000000;       // количество разбиений по умолчанию
-    
-    if (argc > 1) {
-        n = atoi(argv[1]);   // можно передать количество разбиений как аргумент командной строки
+    double tol = 1e-10;      // точность адаптивного метода (абсолютная и относительная)
+    const char *func_name = NULL;  // по умолчанию sin, для --qmc - gfunc
+    const char *expr_src = NULL;
+    double lo = 0.0, hi = 1.0;
+    int has_interval = 0;
+    int romberg = 0;
+    int qmc_dim = 0, qmc_shifts = 16;
+    qmc_sequence_t qmc_seq = QMC_SOBOL;
+    int positional = 0;
+
+    // позиционные аргументы: [разбиений] [точность]; --func <имя> выбирает функцию реестра,
+    // --expr "<выражение>" - функцию, заданную строкой, --interval a b - отрезок,
+    // --qmc <размерность> [--seq sobol|halton] [--shifts R] - многомерный интеграл,
+    // --romberg - только метод ромберга (разбиений - предел числа отрезков)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--list") == 0) {
+            list_integrands();
+            return 0;
+        } else if (strcmp(argv[i], "--func") == 0 && i + 1 < argc) {
+            func_name = argv[++i];
+        } else if (strcmp(argv[i], "--expr") == 0 && i + 1 < argc) {
+            expr_src = argv[++i];
+        } else if (strcmp(argv[i], "--romberg") == 0) {
+            romberg = 1;
+        } else if (strcmp(argv[i], "--qmc") == 0 && i + 1 < argc) {
+            qmc_dim = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seq") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "sobol") == 0) qmc_seq = QMC_SOBOL;
+            else if (strcmp(name, "halton") == 0) qmc_seq = QMC_HALTON;
+            else {
+                fprintf(stderr, "неизвестная последовательность: %s (есть: sobol halton)\n", name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--shifts") == 0 && i + 1 < argc) {
+            qmc_shifts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 2 < argc) {
+            lo = atof(argv[++i]);
+            hi = atof(argv[++i]);
+            has_interval = 1;
+        } else if (positional == 0) {
+            n = atoi(argv[i]);   // количество разбиений
+            positional++;
+        } else {
+            tol = atof(argv[i]);
+            positional++;
+        }
+    }
+
+    if (qmc_dim > 0) {
+        // для квази-монте-карло разбиений - точек на сдвиг, по умолчанию 2^20
+        // явно заданное --func не подменяется: неизвестное имя - ошибка в run_qmc
+        return run_qmc(func_name != NULL ? func_name : "gfunc", qmc_dim,
+                       positional > 0 ? n : 1L << 20, qmc_seq, qmc_shifts);
+    }
+    if (func_name == NULL) func_name = "sin";
+    if (expr_src != NULL) {
+        return run_expression(expr_src, lo, hi, n, tol);  // по умолчанию отрезок [0, 1]
+    }
+    if (strcmp(func_name, "all") == 0) {
+        run_sweep(n, tol);
+        return 0;
+    }
+    const integrand_t *fn = integrand_find(func_name);
+    if (fn == NULL) {
+        fprintf(stderr, "неизвестная функция: %s\n", func_name);
+        list_integrands();
+        return 1;
     }
-    
+
+    // параметры интегрирования
+    double a = has_interval ? lo : fn->a;  // нижний предел интегрирования
+    double b = has_interval ? hi : fn->b;  // верхний предел интегрирования
     double h = (b - a) / n;  // вычисляем шаг интегрирования
-    double exact_value = 2.0; // точное значение ∫sin(x)dx от 0 до π = 2
+    double exact_value = integrand_exact(fn, a, b);  // точное значение по первообразной
 
-    printf("вычисление интеграла ∫sin(x)dx от %.2f до %.2f\n", a, b);
+    printf("вычисление интеграла ∫%s dx от %.2f до %.2f\n", fn->label, a, b);
     printf("количество разбиений: %d\n", n);
     printf("шаг h: %.10f\n", h);
     printf("точное значение: %.10f\n", exact_value);
+    if (romberg) {
+        run_romberg(fn, a, b, exact_value, n, tol);
+        return 0;
+    }
+    if (roofline_enabled()) roofline_print_machine(roofline_get());  // stream и пик fma этой машины
+    // на точку: x = a + (i + 0.5) * h, f(x) * h и сложение - 4 операции без учета f;
+    // операции f неизвестны, поэтому доля потолка не печатается
+    roofline_kernel_t integral_kernel = {"интеграл, без учета f", 0.0, 4.0, 1};
 
-    // последовательная версия (метод прямоугольников)
-    double seq_integral = 0.0;  // переменная для накопления результата
+    // последовательная версия (метод средних прямоугольников, цикл со встроенной f)
     double seq_start = omp_get_wtime();  // засекаем время начала выполнения
-    
-    // метод средних прямоугольников: используем значение функции в середине интервала
-    for (int i = 0; i < n; i++) {
-        double x = a + (i + 0.5) * h;  // вычисляем x в середине интервала
-        seq_integral += f(x) * h;       // добавляем площадь прямоугольника
-    }
-    
+    double seq_integral = fn->midpoint_seq(a, h, n);
     double seq_time = omp_get_wtime() - seq_start;  // вычисляем время выполнения
 
     printf("\nпоследовательная версия:\n");
@@ -45,18 +456,9 @@ int main(int argc, char *argv[]) {
     printf("  погрешность: %.10f\n", fabs(seq_integral - exact_value));  // абсолютная погрешность
     printf("  время: %.4f секунд\n", seq_time);
 
-    // параллельная версия с использованием редукции
-    double red_integral = 0.0;  // переменная для накопления результата
+    // параллельная версия с использованием редукции (#pragma omp parallel for reduction(+:sum))
     double red_start = omp_get_wtime();  // засекаем время начала
-
-    // директива openmp для параллельного цикла с редукцией сложения
-    #pragma omp parallel for reduction(+:red_integral)
-    for (int i = 0; i < n; i++) {
-        double x = a + (i + 0.5) * h;  // каждый поток вычисляет свою точку
-        red_integral += f(x) * h;       // каждый поток накапливает свою часть суммы
-    }
-    // openmp автоматически суммирует результаты всех потоков
-
+    double red_integral = fn->midpoint_reduction(a, h, n);
     double red_time = omp_get_wtime() - red_start;  // вычисляем время выполнения
 
     printf("\nпараллельная версия (редукция):\n");
@@ -64,29 +466,11 @@ int main(int argc, char *argv[]) {
     printf("  погрешность: %.10f\n", fabs(red_integral - exact_value));
     printf("  время: %.4f секунд\n", red_time);
     printf("  ускорение: %.2fx\n", seq_time / red_time);  // вычисляем ускорение
+    roofline_report(&integral_kernel, n, red_time);
 
-    // параллельная версия без редукции с использованием критических секций
-    double crit_integral = 0.0;  // переменная для накопления результата
+    // параллельная версия без редукции: локальные суммы потоков складываются в критической секции
     double crit_start = omp_get_wtime();  // засекаем время начала
-
-    #pragma omp parallel
-    {
-        double local_integral = 0.0;  // локальная переменная для каждого потока
-        
-        // каждый поток вычисляет свою часть интеграла
-        #pragma omp for
-        for (int i = 0; i < n; i++) {
-            double x = a + (i + 0.5) * h;  // вычисляем точку в середине интервала
-            local_integral += f(x) * h;     // накапливаем локальную сумму
-        }
-        
-        // суммируем результаты всех потоков через критические секции
-        #pragma omp critical
-        {
-            crit_integral += local_integral;  // безопасное добавление к глобальному результату
-        }
-    }
-
+    double crit_integral = fn->midpoint_critical(a, h, n);
     double crit_time = omp_get_wtime() - crit_start;  // вычисляем время выполнения
 
     printf("\nпараллельная версия (критические секции):\n");
@@ -95,10 +479,78 @@ int main(int argc, char *argv[]) {
     printf("  время: %.4f секунд\n", crit_time);
     printf("  ускорение: %.2fx\n", seq_time / crit_time);  // вычисляем ускорение
 
+    // метод средних прямоугольников с векторизованной функцией (4 абсциссы за инструкцию при avx2)
+    for (int acc = SIMD_MATH_PRECISE; fn->simd != NULL && acc <= SIMD_MATH_FAST; acc++) {
+        // у sin и cos один уровень точности: быстрый запуск повторил бы точный
+        if (acc == SIMD_MATH_FAST && (fn->simd == simd_sin || fn->simd == simd_cos)) break;
+        loop_profile_t *profile = loop_profile_begin(simd_math_accuracy_name((simd_math_accuracy_t)acc));
+        double simd_start = omp_get_wtime();
+        double simd_integral = midpoint_simd(fn, a, h, n, (simd_math_accuracy_t)acc, profile);
+        double simd_time = omp_get_wtime() - simd_start;
+
+        printf("\nпараллельная версия (редукция + simd %s, %s):\n", fn->name,
+               simd_math_accuracy_name((simd_math_accuracy_t)acc));
+        printf("  приближенное значение: %.10f\n", simd_integral);
+        printf("  погрешность: %.10f\n", fabs(simd_integral - exact_value));
+        printf("  время: %.4f секунд\n", simd_time);
+        printf("  ускорение: %.2fx (относительно редукции с libm: %.2fx)\n",
+               seq_time / simd_time, red_time / simd_time);
+        loop_profile_report(profile);
+    }
+
+    // то же выражение, разобранное во время выполнения и вычисляемое интерпретатором байт-кода
+    expr_program_t prog;
+    char error[128];
+    if (expr_compile(fn->source, &prog, error) == 0) {
+        double vm_start = omp_get_wtime();
+        double vm_integral = midpoint_expr(&prog, a, h, n);
+        double vm_time = omp_get_wtime() - vm_start;
+
+        printf("\nпараллельная версия (редукция, байт-код \"%s\", %d инструкций):\n", fn->source, prog.length);
+        printf("  приближенное значение: %.10f\n", vm_integral);
+        printf("  погрешность: %.10f\n", fabs(vm_integral - exact_value));
+        printf("  время: %.4f секунд\n", vm_time);
+        printf("  скорость: %.1f млн точек/с (скомпилированная редукция: %.1f млн точек/с, отношение %.2fx)\n",
+               n / vm_time / 1e6, n / red_time / 1e6, red_time / vm_time);
+    }
+
+    // адаптивная квадратура гаусса-кронрода g7-k15 (задачи openmp + очередь худших отрезков)
+    double gk_start = omp_get_wtime();
+    gk_result_t gk = gk_integrate(fn->batch, NULL, a, b, tol, tol, 100000000L);
+    double gk_time = omp_get_wtime() - gk_start;
+
+    printf("\nадаптивная версия (гаусс-кронрод g7-k15, точность %.1e):\n", tol);
+    printf("  приближенное значение: %.10f\n", gk.result);
+    printf("  погрешность: %.10f (оценка: %.2e)%s\n", fabs(gk.result - exact_value), gk.error,
+           gk_status_note(&gk));
+    printf("  вычислений функции: %ld (в %.0f раз меньше, чем у метода прямоугольников), отрезков: %ld\n",
+           gk.evaluations, (double)n / gk.evaluations, gk.intervals);
+    printf("  время: %.6f секунд\n", gk_time);
+    printf("  ускорение: %.2fx (относительно редукции: %.2fx)\n", seq_time / gk_time, red_time / gk_time);
+
+    // та же адаптивная схема на функции с острым пиком: деления по потокам показывают баланс
+    const integrand_t *pk = integrand_find("peak");
+    double peak_exact = integrand_exact(pk, pk->a, pk->b);
+    double peak_start = omp_get_wtime();
+    gk_result_t peak = gk_integrate(pk->batch, NULL, pk->a, pk->b, tol, tol, 100000000L);
+    double peak_time = omp_get_wtime() - peak_start;
+
+    printf("\nадаптивная версия, пиковая функция %s:\n", pk->label);
+    printf("  приближенное значение: %.10f (точное: %.10f)\n", peak.result, peak_exact);
+    printf("  относительная погрешность: %.2e (оценка: %.2e)\n",
+           fabs(peak.result - peak_exact) / peak_exact, peak.error / peak_exact);
+    printf("  вычислений функции: %ld, отрезков: %ld\n", peak.evaluations, peak.intervals);
+    printf("  делений на поток: от %ld до %ld\n", peak.refined_min, peak.refined_max);
+    printf("  время: %.6f секунд\n", peak_time);
+
+    // время и точность отдельных функций: libm против векторизованных версий
+    compare_math_functions(n < (1 << 22) ? n : (1 << 22));
+
     // сравнение численных результатов методов между собой
     printf("\nсравнение методов:\n");
     printf("  разница (редукция): %.10f\n", fabs(seq_integral - red_integral));  // сравнение с последовательной версией
     printf("  разница (крит.секции): %.10f\n", fabs(seq_integral - crit_integral));  // сравнение с последовательной версией
+    printf("  разница (адаптивная): %.10f\n", fabs(seq_integral - gk.result));
 
     return 0;
 }
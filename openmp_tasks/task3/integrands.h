@@ -0,0 +1,144 @@
+#ifndef INTEGRANDS_H
+#define INTEGRANDS_H
+
+// реестр подынтегральных функций с известными первообразными
+//
+// каждая функция описывается одной строкой INTEGRAND_LIST:
+//   X(имя, подпись, выражение от x, a, b, первообразная от x, simd-функция или NULL)
+// для каждой строки макрос INTEGRAND_DEFINE порождает inline-функцию и отдельные
+// циклы метода прямоугольников (последовательный, редукция, критические секции),
+// в которые выражение подставляется напрямую - компилятор встраивает и векторизует
+// его, а выбор функции по имени (--func) стоит один косвенный вызов на весь интеграл,
+// а не на каждую точку. точное значение берется из первообразной: F(b) - F(a)
+//
+// новая функция - одна строка в INTEGRAND_LIST, без правки циклов и main
+// выражение записывается синтаксисом, общим для c и интерпретатора expr_vm.h,
+// чтобы по тексту строки сравнить скомпилированный цикл и байт-код; текст берется
+// после подстановки макросов (INTEGRAND_SOURCE), поэтому константы вроде PEAK_WIDTH
+// попадают в строку числами
+
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "../../common/gauss_kronrod.h"
+#include "../../common/simd_math.h"
+
+#define PEAK_WIDTH 1e-3  // ширина пика функции peak: почти все деления - около x = 1
+#define PEAK_STR(v) #v
+#define PEAK_LABEL(v) "1/((x-1)^2+" PEAK_STR(v) "^2)"  // подпись с раскрытой PEAK_WIDTH
+
+#define INTEGRAND_LIST(X) \
+    X(sin,     "sin(x)",          sin(x),                        0.0, M_PI,       -cos(x),                                   simd_sin) \
+    X(cos,     "cos(x)",          cos(x),                        0.0, M_PI / 2,   sin(x),                                    simd_cos) \
+    X(square,  "x^2",             x * x,                         0.0, 1.0,        x * x * x / 3.0,                           NULL) \
+    X(cube,    "x^3",             x * x * x,                     0.0, 1.0,        x * x * x * x / 4.0,                       NULL) \
+    X(poly,    "x^5 - 2x^2 + 1",  (x * x * x - 2.0) * x * x + 1.0, -1.0, 2.0,     x * x * x * x * x * x / 6.0 - 2.0 * x * x * x / 3.0 + x, NULL) \
+    X(sqrt,    "sqrt(x)",         sqrt(x),                       0.0, 1.0,        2.0 / 3.0 * x * sqrt(x),                   NULL) \
+    X(exp,     "e^x",             exp(x),                        0.0, 1.0,        exp(x),                                    simd_exp) \
+    X(expneg,  "e^-x",            exp(-x),                       0.0, 10.0,       -exp(-x),                                  NULL) \
+    X(gauss,   "e^(-x^2)",        exp(-x * x),                   0.0, 2.0,        0.5 * sqrt(M_PI) * erf(x),                 NULL) \
+    X(log,     "ln(x)",           log(x),                        1.0, 2.0,        x * log(x) - x,                            simd_log) \
+    X(inv,     "1/x",             1.0 / x,                       1.0, M_E,        log(x),                                    NULL) \
+    X(atan,    "1/(1+x^2)",       1.0 / (1.0 + x * x),           0.0, 1.0,        atan(x),                                   NULL) \
+    X(xsin,    "x*sin(x)",        x * sin(x),                    0.0, M_PI,       sin(x) - x * cos(x),                       NULL) \
+    X(sin2,    "sin^2(x)",        sin(x) * sin(x),               0.0, M_PI,       0.5 * x - 0.25 * sin(2.0 * x),             NULL) \
+    X(sec2,    "1/cos^2(x)",      1.0 / (cos(x) * cos(x)),       0.0, 1.0,        tan(x),                                    NULL) \
+    X(cosh,    "cosh(x)",         cosh(x),                       -1.0, 1.0,       sinh(x),                                   NULL) \
+    X(peak,    PEAK_LABEL(PEAK_WIDTH), 1.0 / ((x - 1.0) * (x - 1.0) + PEAK_WIDTH * PEAK_WIDTH), 0.0, M_PI, \
+                                  atan((x - 1.0) / PEAK_WIDTH) / PEAK_WIDTH,  NULL)
+
+typedef double (*integrand_loop_t)(double a, double h, int n);
+typedef void (*integrand_simd_t)(const double *x, double *y, long n, simd_math_accuracy_t acc);
+
+typedef struct {
+    const char *name;
+    const char *label;
+    const char *source;                   // выражение текстом (для интерпретатора expr_vm.h)
+    double a, b;                          // отрезок интегрирования по умолчанию
+    double (*f)(double x);                // значение в точке (для проверок, не для горячих циклов)
+    double (*antiderivative)(double x);
+    integrand_loop_t midpoint_seq;        // специализированные циклы метода прямоугольников
+    integrand_loop_t midpoint_reduction;
+    integrand_loop_t midpoint_critical;
+    gk_batch_fn_t batch;                  // пачка значений для адаптивного интегратора
+    integrand_simd_t simd;                // векторизованная версия (simd_math.h) или NULL
+} integrand_t;
+
+// функции одной строки реестра: выражение expr подставляется в каждый цикл
+#define INTEGRAND_DEFINE(name, label, expr, lo, hi, anti, simd_fn) \
+    static inline double integrand_##name(double x) { return (expr); } \
+    static inline double antiderivative_##name(double x) { return (anti); } \
+    \
+    static double midpoint_seq_##name(double a, double h, int n) { \
+        double sum = 0.0; \
+        for (int i = 0; i < n; i++) { \
+            double x = a + (i + 0.5) * h; \
+            sum += (expr) * h; \
+        } \
+        return sum; \
+    } \
+    \
+    static double midpoint_reduction_##name(double a, double h, int n) { \
+        double sum = 0.0; \
+        _Pragma("omp parallel for reduction(+:sum)") \
+        for (int i = 0; i < n; i++) { \
+            double x = a + (i + 0.5) * h; \
+            sum += (expr) * h; \
+        } \
+        return sum; \
+    } \
+    \
+    static double midpoint_critical_##name(double a, double h, int n) { \
+        double sum = 0.0; \
+        _Pragma("omp parallel") \
+        { \
+            double local_sum = 0.0; \
+            _Pragma("omp for") \
+            for (int i = 0; i < n; i++) { \
+                double x = a + (i + 0.5) * h; \
+                local_sum += (expr) * h; \
+            } \
+            _Pragma("omp critical") \
+            sum += local_sum; \
+        } \
+        return sum; \
+    } \
+    \
+    static void batch_##name(const double *xs, double *fx, int count, void *ctx) { \
+        (void)ctx; \
+        for (int i = 0; i < count; i++) { \
+            double x = xs[i]; \
+            fx[i] = (expr); \
+        } \
+    }
+
+// строка выражения после подстановки макросов (аргумент раскрывается до #)
+#define INTEGRAND_SOURCE(expr) #expr
+
+#define INTEGRAND_ENTRY(name, label, expr, lo, hi, anti, simd_fn) \
+    {#name, label, INTEGRAND_SOURCE(expr), lo, hi, integrand_##name, antiderivative_##name, \
+     midpoint_seq_##name, midpoint_reduction_##name, midpoint_critical_##name, \
+     batch_##name, simd_fn},
+
+INTEGRAND_LIST(INTEGRAND_DEFINE)
+
+static const integrand_t integrands[] = {
+    INTEGRAND_LIST(INTEGRAND_ENTRY)
+};
+
+#define INTEGRAND_COUNT ((int)(sizeof(integrands) / sizeof(integrands[0])))
+
+// поиск по имени; NULL - такой функции нет
+static inline const integrand_t *integrand_find(const char *name) {
+    for (int i = 0; i < INTEGRAND_COUNT; i++) {
+        if (strcmp(integrands[i].name, name) == 0) return &integrands[i];
+    }
+    return NULL;
+}
+
+// точное значение интеграла по [a, b] из первообразной
+static inline double integrand_exact(const integrand_t *it, double a, double b) {
+    return it->antiderivative(b) - it->antiderivative(a);
+}
+
+#endif // INTEGRANDS_H
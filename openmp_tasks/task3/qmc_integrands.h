@@ -0,0 +1,97 @@
+#ifndef QMC_INTEGRANDS_H
+#define QMC_INTEGRANDS_H
+
+// многомерные подынтегральные функции на [0, 1]^d с известным интегралом
+// (тестовые функции genz и g-функция соболя) для квази-монте-карло (../../common/qmc.h)
+//
+// как и в integrands.h, строка QMC_INTEGRAND_LIST порождает пачечную функцию,
+// в цикл которой значение в точке встраивается; выбор по имени - один косвенный
+// вызов на блок из QMC_BLOCK точек
+
+#include <string.h>
+#include <math.h>
+#include "../../common/qmc.h"
+
+// сумма квадратов: d/3
+static inline double qmc_f_sumsq(const double *u, int d) {
+    double s = 0.0;
+    for (int i = 0; i < d; i++) s += u[i] * u[i];
+    return s;
+}
+
+// g-функция соболя с a_i = i: произведение (|4u - 2| + a) / (1 + a), интеграл 1
+static inline double qmc_f_gfunc(const double *u, int d) {
+    double p = 1.0;
+    for (int i = 0; i < d; i++) p *= (fabs(4.0 * u[i] - 2.0) + i) / (1.0 + i);
+    return p;
+}
+
+// гауссова функция exp(-|u|^2): (sqrt(pi)/2 * erf(1))^d
+static inline double qmc_f_gauss(const double *u, int d) {
+    return exp(-qmc_f_sumsq(u, d));
+}
+
+// осциллирующая cos(u_1 + ... + u_d): (2 sin(1/2))^d cos(d/2)
+static inline double qmc_f_oscill(const double *u, int d) {
+    double s = 0.0;
+    for (int i = 0; i < d; i++) s += u[i];
+    return cos(s);
+}
+
+// угловой пик (1 + u_1 + ... + u_d)^-(d+1): сумма по k (-1)^k C(d,k) / (1 + k) / d!
+static inline double qmc_f_corner(const double *u, int d) {
+    double s = 1.0;
+    for (int i = 0; i < d; i++) s += u[i];
+    return pow(s, -(d + 1));
+}
+
+static inline double qmc_exact_corner(int d) {
+    double sum = 0.0, binom = 1.0, fact = 1.0;
+    for (int k = 0; k <= d; k++) {
+        sum += (k & 1 ? -binom : binom) / (1.0 + k);
+        binom = binom * (d - k) / (k + 1);
+    }
+    for (int k = 2; k <= d; k++) fact *= k;
+    return sum / fact;
+}
+
+#define QMC_INTEGRAND_LIST(X) \
+    X(sumsq,  "u1^2 + ... + ud^2",          d / 3.0) \
+    X(gfunc,  "g-функция соболя",           1.0) \
+    X(gauss,  "exp(-|u|^2)",                pow(0.5 * sqrt(M_PI) * erf(1.0), d)) \
+    X(oscill, "cos(u1 + ... + ud)",         pow(2.0 * sin(0.5), d) * cos(0.5 * d)) \
+    X(corner, "(1 + u1 + ... + ud)^-(d+1)", qmc_exact_corner(d))
+
+typedef struct {
+    const char *name;
+    const char *label;
+    qmc_fn_t batch;
+    double (*exact)(int d);
+} qmc_integrand_t;
+
+#define QMC_INTEGRAND_DEFINE(name, label, exact_expr) \
+    static void qmc_batch_##name(const double *u, double *fu, int count, int dim, void *ctx) { \
+        (void)ctx; \
+        for (int p = 0; p < count; p++) fu[p] = qmc_f_##name(u + (long)p * dim, dim); \
+    } \
+    static double qmc_exact_value_##name(int d) { (void)d; return (exact_expr); }
+
+#define QMC_INTEGRAND_ENTRY(name, label, exact_expr) \
+    {#name, label, qmc_batch_##name, qmc_exact_value_##name},
+
+QMC_INTEGRAND_LIST(QMC_INTEGRAND_DEFINE)
+
+static const qmc_integrand_t qmc_integrands[] = {
+    QMC_INTEGRAND_LIST(QMC_INTEGRAND_ENTRY)
+};
+
+#define QMC_INTEGRAND_COUNT ((int)(sizeof(qmc_integrands) / sizeof(qmc_integrands[0])))
+
+static inline const qmc_integrand_t *qmc_integrand_find(const char *name) {
+    for (int i = 0; i < QMC_INTEGRAND_COUNT; i++) {
+        if (strcmp(qmc_integrands[i].name, name) == 0) return &qmc_integrands[i];
+    }
+    return NULL;
+}
+
+#endif // QMC_INTEGRANDS_H
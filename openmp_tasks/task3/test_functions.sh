@@ -2,8 +2,17 @@
 echo "сравнение разных подынтегральных функций (4 потока, 100M разбиений):"
 echo "===================================================================="
 
-echo "можно тестировать разные функции, модифицируя f(x) в коде:"
-echo "1. sin(x) от 0 до π    (точное значение: 2)"
-echo "2. x² от 0 до 1        (точное значение: 1/3 ≈ 0.333...)"
-echo "3. e^x от 0 до 1       (точное значение: e-1 ≈ 1.718...)"
-echo "4. 1/(1+x²) от 0 до 1  (точное значение: π/4 ≈ 0.785...)"
+# функции берутся из реестра integrands.h, точные значения - из первообразных
+./integral --list
+echo ""
+
+# сводная таблица по всем функциям: метод прямоугольников с редукцией и адаптивный метод
+OMP_NUM_THREADS=4 ./integral 100000000 --func all
+echo ""
+
+# подробный отчет для нескольких функций
+for func in sin square exp atan; do
+    echo "--- функция: $func ---"
+    OMP_NUM_THREADS=4 ./integral 100000000 --func $func
+    echo ""
+done
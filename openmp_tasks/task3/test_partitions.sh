@@ -9,3 +9,8 @@ for n in 1000000 10000000 100000000 500000000; do
     OMP_NUM_THREADS=4 ./integral $n
     echo ""
 done
+
+# тот же перебор одним запуском: метод ромберга удваивает число отрезков, используя
+# все прежние точки, и останавливается по точности - стоит как самое мелкое разбиение
+echo "--- метод ромберга (до 500M отрезков, точность 1e-12) ---"
+OMP_NUM_THREADS=4 ./integral 500000000 1e-12 --romberg
@@ -3,31 +3,233 @@
 #include <omp.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include "../../common/philox_rng.h"
+#include "../../common/numa_alloc.h"
+#include "../../common/roofline.h"
+#include "../../common/matrix.h"
+#include "../../common/maximin.h"
+#include "../../common/loop_profile.h"
 
 // функция для заполнения матрицы случайными числами
-void fill_matrix(double **matrix, int rows, int cols) {
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            matrix[i][j] = (double)rand() / RAND_MAX * 100.0;  // генерируем числа от 0 до 100
-        }
+// элемент (i, j) имеет номер i * cols + j в последовательности philox,
+// поэтому строки заполняются параллельно и результат не зависит от числа потоков
+void fill_matrix(const matrix_t *matrix, uint64_t seed) {
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < matrix->rows; i++) {
+        // числа от 0 до 100
+        rng_fill_range(matrix_row(matrix, i), matrix->cols, seed, 0, (uint64_t)i * matrix->cols, 0.0, 100.0);
     }
 }
 
 // функция для вывода матрицы (для маленьких размеров)
-void print_matrix(double **matrix, int rows, int cols) {
-    if (rows > 10 || cols > 10) {
+void print_matrix(const matrix_t *matrix) {
+    if (matrix->rows > 10 || matrix->cols > 10) {
         printf("матрица слишком большая для вывода\n");
         return;
     }
     
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            printf("%6.1f ", matrix[i][j]);  // форматированный вывод элементов
+    for (long i = 0; i < matrix->rows; i++) {
+        for (long j = 0; j < matrix->cols; j++) {
+            printf("%6.1f ", MATRIX_AT(matrix, i, j));  // форматированный вывод элементов
         }
         printf("\n");
     }
 }
 
+// maximin по строкам, заданным массивом указателей (прежняя раскладка double**)
+double maximin_row_pointers(double **rows_ptr, int rows, int cols) {
+    double result = -1.0;
+    #pragma omp parallel for schedule(static) reduction(max:result)
+    for (int i = 0; i < rows; i++) {
+        const double *row = rows_ptr[i];
+        double row_min = row[0];
+        for (int j = 1; j < cols; j++) {
+            if (row[j] < row_min) row_min = row[j];
+        }
+        if (row_min > result) result = row_min;
+    }
+    return result;
+}
+
+// тот же maximin по непрерывному буферу
+double maximin_contiguous(const matrix_t *matrix) {
+    double result = -1.0;
+    #pragma omp parallel for schedule(static) reduction(max:result)
+    for (long i = 0; i < matrix->rows; i++) {
+        const double *row = matrix_row(matrix, i);
+        double row_min = row[0];
+        for (long j = 1; j < matrix->cols; j++) {
+            if (row[j] < row_min) row_min = row[j];
+        }
+        if (row_min > result) result = row_min;
+    }
+    return result;
+}
+
+// maximin с отсечением (ветви и границы)
+// строка не может поднять ответ, как только ее текущий минимум опустился до лучшего
+// найденного максимума минимумов best - дальше строку можно не смотреть
+// - best общий для всех потоков: читается атомарно (relaxed) после каждого блока
+//   из MAXIMIN_BLOCK элементов, повышается в критической секции с перепроверкой
+// - верхняя граница строки - минимум MAXIMIN_SAMPLES элементов, взятых с равным шагом;
+//   строки обходятся по убыванию границы, чтобы best сразу стал большим, а строка
+//   с границей <= best пропускается целиком
+// - минимум блока - maximin_block_min (без ветвлений, 4 аккумулятора)
+// - при samples == cols выборка и есть вся строка: отсекать нечего, без выборки,
+//   сортировки и второго обхода выполняется обычный maximin_by_rows; он же -
+//   при нехватке памяти под порядок строк
+// visited - сколько элементов прочитано всего: выборка (rows * samples) и обход строк
+#define MAXIMIN_BLOCK 64
+#define MAXIMIN_SAMPLES 16
+
+typedef struct {
+    double bound;  // минимум выборки - не меньше минимума строки
+    long row;
+} row_bound_t;
+
+static int compare_bound_desc(const void *a, const void *b) {
+    double x = ((const row_bound_t*)a)->bound, y = ((const row_bound_t*)b)->bound;
+    return (x < y) - (x > y);
+}
+
+double maximin_pruned(const matrix_t *matrix, long *visited) {
+    long rows = matrix->rows, cols = matrix->cols;
+    long samples = cols < MAXIMIN_SAMPLES ? cols : MAXIMIN_SAMPLES;
+    // выборка - вся строка (границы точные) или нет памяти под порядок строк
+    row_bound_t *order = samples < cols ? (row_bound_t*)malloc(rows * sizeof(row_bound_t)) : NULL;
+    if (order == NULL) {
+        if (visited != NULL) *visited = rows * cols;
+        return maximin_by_rows(matrix);
+    }
+
+    // дешевая верхняя граница каждой строки по выборке
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < rows; i++) {
+        const double *row = matrix_row(matrix, i);
+        double bound = row[0];
+        for (long k = 1; k < samples; k++) {
+            double v = row[k * cols / samples];
+            bound = v < bound ? v : bound;
+        }
+        order[i].bound = bound;
+        order[i].row = i;
+    }
+    qsort(order, rows, sizeof(row_bound_t), compare_bound_desc);
+
+    double best = -1.0;
+    long total_visited = rows * samples;  // выборка читает samples элементов каждой строки
+    // строки с разной длиной обхода - динамическое распределение по отсортированному порядку
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:total_visited)
+    for (long r = 0; r < rows; r++) {
+        double current;
+        #pragma omp atomic read
+        current = best;
+        double row_min = order[r].bound;  // элементы выборки уже учтены
+        if (row_min <= current) continue;  // граница не выше best - строка не нужна
+
+        const double *row = matrix_row(matrix, order[r].row);
+        long j = 0;
+        while (j < cols) {
+            long n = cols - j < MAXIMIN_BLOCK ? cols - j : MAXIMIN_BLOCK;
+            row_min = maximin_block_min(row + j, n, row_min);
+            total_visited += n;
+            j += n;
+            #pragma omp atomic read
+            current = best;
+            if (row_min <= current) break;  // строка отброшена
+        }
+        if (j == cols && row_min > current) {
+            #pragma omp critical (maximin_best)
+            {
+                #pragma omp atomic read
+                current = best;
+                if (row_min > current) {
+                    #pragma omp atomic write
+                    best = row_min;
+                }
+            }
+        }
+    }
+
+    free(order);
+    if (visited != NULL) *visited = total_visited;
+    return best;
+}
+
+// сравнение раскладок: rows вызовов malloc и указатели на строки против одного
+// выровненного буфера. только по запросу (LAYOUT_COMPARE=1): вторая копия матрицы
+// удваивает память (при 50000 x 50000 - еще 20 ГБ)
+void compare_layouts(const matrix_t *matrix) {
+    const char *env = getenv("LAYOUT_COMPARE");
+    if (env == NULL || *env == '\0' || strcmp(env, "0") == 0) return;
+    int rows = (int)matrix->rows, cols = (int)matrix->cols;
+
+    // прежняя раскладка: массив указателей и отдельный malloc на строку
+    double alloc_start = omp_get_wtime();
+    double **rows_ptr = (double**)calloc(rows, sizeof(double*));
+    if (rows_ptr == NULL) {
+        printf("\nраскладка памяти: не хватает памяти для копии матрицы, сравнение пропущено\n");
+        return;
+    }
+    int alloc_failed = 0;
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        rows_ptr[i] = (double*)malloc(cols * sizeof(double));
+        if (rows_ptr[i] == NULL) {
+            #pragma omp atomic write
+            alloc_failed = 1;
+            continue;
+        }
+        memset(rows_ptr[i], 0, cols * sizeof(double));
+    }
+    double ptr_alloc_time = omp_get_wtime() - alloc_start;
+
+    alloc_start = omp_get_wtime();
+    matrix_t probe = matrix_alloc(rows, cols);  // одно выделение того же размера
+    double contig_alloc_time = omp_get_wtime() - alloc_start;
+    if (probe.data == NULL) alloc_failed = 1;
+    matrix_free(&probe);
+
+    if (alloc_failed) {
+        printf("\nраскладка памяти: не хватает памяти для копии матрицы, сравнение пропущено\n");
+        for (int i = 0; i < rows; i++) free(rows_ptr[i]);  // free(NULL) допустим
+        free(rows_ptr);
+        return;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        memcpy(rows_ptr[i], matrix_row(matrix, i), cols * sizeof(double));
+    }
+
+    // лучшее из 3 запусков для каждой раскладки
+    double ptr_time = 1e30, contig_time = 1e30, ptr_result = 0.0, contig_result = 0.0;
+    for (int rep = 0; rep < 3; rep++) {
+        double start = omp_get_wtime();
+        ptr_result = maximin_row_pointers(rows_ptr, rows, cols);
+        double t = omp_get_wtime() - start;
+        if (t < ptr_time) ptr_time = t;
+
+        start = omp_get_wtime();
+        contig_result = maximin_contiguous(matrix);
+        t = omp_get_wtime() - start;
+        if (t < contig_time) contig_time = t;
+    }
+
+    printf("\nраскладка памяти (указатели на строки против непрерывного буфера, ld = %ld):\n", matrix->ld);
+    printf("  выделение: %d malloc - %.4f секунд, один буфер - %.4f секунд\n",
+           rows + 1, ptr_alloc_time, contig_alloc_time);
+    printf("  maximin (редукция): указатели %.4f секунд, непрерывный %.4f секунд (%.2fx)\n",
+           ptr_time, contig_time, ptr_time / contig_time);
+    printf("  разница результатов: %.10f\n", fabs(ptr_result - contig_result));
+
+    for (int i = 0; i < rows; i++) {
+        free(rows_ptr[i]);
+    }
+    free(rows_ptr);
+}
+
 int main(int argc, char *argv[]) {
     // размер матрицы можно передавать как аргументы командной строки
     int rows = 1000;    // количество строк по умолчанию
@@ -37,23 +239,40 @@ int main(int argc, char *argv[]) {
         rows = atoi(argv[1]);  // преобразуем первый аргумент в число строк
         cols = atoi(argv[2]);  // преобразуем второй аргумент в число столбцов
     }
+    if (rows < 1 || cols < 1) {
+        printf("размеры матрицы должны быть положительными\n");
+        return 1;
+    }
 
-    // выделяем память под матрицу (массив указателей на строки)
-    double **matrix = (double**)malloc(rows * sizeof(double*));
-    for (int i = 0; i < rows; i++) {
-        matrix[i] = (double*)malloc(cols * sizeof(double));  // выделяем память для каждой строки
+    // выделяем память под матрицу: один буфер с выровненными строками (ld кратно 8)
+    // буфер обнуляется параллельно с тем же schedule(static), что и в вычислительных
+    // циклах: первое касание размещает строку на узле numa ее потока
+    double alloc_start = omp_get_wtime();
+    matrix_t matrix = matrix_alloc(rows, cols);
+    double alloc_time = omp_get_wtime() - alloc_start;
+    if (matrix.data == NULL) {
+        printf("не удалось выделить память под матрицу %d x %d\n", rows, cols);
+        return 1;
     }
 
-    // инициализируем генератор случайных чисел текущим временем
-    srand(time(NULL));
-    fill_matrix(matrix, rows, cols);  // заполняем матрицу случайными значениями
+    // seed фиксирован (или задается через RNG_SEED), поэтому запуски воспроизводимы
+    uint64_t seed = rng_seed_from_env();
+    double fill_start = omp_get_wtime();
+    fill_matrix(&matrix, seed);  // заполняем матрицу случайными значениями
+    double fill_time = omp_get_wtime() - fill_start;
 
     printf("размер матрицы: %d x %d\n", rows, cols);
+    printf("выделение памяти: %.4f секунд, seed: %llu, генерация данных: %.4f секунд\n",
+           alloc_time, (unsigned long long)seed, fill_time);
+    numa_print_binding();  // OMP_PLACES / OMP_PROC_BIND и размещение потоков по узлам
+    if (roofline_enabled()) roofline_print_machine(roofline_get());  // stream и пик fma этой машины
+    // на элемент: чтение 8 байт и одно сравнение с минимумом строки
+    roofline_kernel_t maximin_kernel = {"maximin", sizeof(double), 1.0, 0};
     
     // выводим матрицу только если она маленькая (для отладки)
     if (rows <= 5 && cols <= 5) {
         printf("матрица:\n");
-        print_matrix(matrix, rows, cols);
+        print_matrix(&matrix);
     }
 
     // последовательная версия алгоритма
@@ -63,10 +282,11 @@ int main(int argc, char *argv[]) {
     // находим минимумы для каждой строки матрицы
     double *row_minima = (double*)malloc(rows * sizeof(double));  // массив для хранения минимумов строк
     for (int i = 0; i < rows; i++) {
-        double min_val = matrix[i][0];  // начинаем с первого элемента строки
+        const double *row = matrix_row(&matrix, i);
+        double min_val = row[0];  // начинаем с первого элемента строки
         for (int j = 1; j < cols; j++) {
-            if (matrix[i][j] < min_val) {
-                min_val = matrix[i][j];  // обновляем минимум если нашли меньший элемент
+            if (row[j] < min_val) {
+                min_val = row[j];  // обновляем минимум если нашли меньший элемент
             }
         }
         row_minima[i] = min_val;  // сохраняем минимум текущей строки
@@ -88,20 +308,26 @@ int main(int argc, char *argv[]) {
 
     // параллельная версия с редукцией (внешний параллелизм)
     double red_result = 0.0;  // переменная для результата
+    int used_threads = 1;
+    numa_thread_bw_t *thread_bw = (numa_thread_bw_t*)calloc(omp_get_max_threads(), sizeof(numa_thread_bw_t));
+    loop_profile_t *profile = loop_profile_begin("reduction");  // NULL без LOOP_PROFILE=1
     double red_start = omp_get_wtime();  // засекаем время начала
 
     #pragma omp parallel
     {
         double local_max = -1.0;  // локальный максимум для текущего потока
+        double thread_start = omp_get_wtime();
+        loop_probe_t probe = loop_probe_start(profile);
         
         // распределяем строки матрицы между потоками
-        #pragma omp for
-        for (int i = 0; i < rows; i++) {
+        // schedule(static) совпадает с распределением при выделении строк
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait", (int i = 0; i < rows; i++), i, LOOP_CHUNK_STATIC,
             // находим минимум в текущей строке (последовательно)
-            double row_min = matrix[i][0];
+            const double *row = matrix_row(&matrix, i);
+            double row_min = row[0];
             for (int j = 1; j < cols; j++) {
-                if (matrix[i][j] < row_min) {
-                    row_min = matrix[i][j];
+                if (row[j] < row_min) {
+                    row_min = row[j];
                 }
             }
             
@@ -109,7 +335,19 @@ int main(int argc, char *argv[]) {
             if (row_min > local_max) {
                 local_max = row_min;
             }
+        );
+        double thread_time = omp_get_wtime() - thread_start;
+        // строки потока - из разбиения schedule(static), а не счетчиком в цикле
+        long begin, end;
+        numa_static_range(rows, &begin, &end);
+        if (thread_bw != NULL) {
+            numa_record(&thread_bw[omp_get_thread_num()], (double)(end - begin) * cols * sizeof(double),
+                        thread_time);
         }
+        #pragma omp single nowait
+        used_threads = omp_get_num_threads();
+        // барьер после замера потока: ожидание не входит в его пропускную способность
+        loop_probe_finish(profile, &probe);
         
         // критическая секция для безопасного обновления глобального результата
         #pragma omp critical
@@ -126,64 +364,94 @@ int main(int argc, char *argv[]) {
     printf("  максимум среди минимумов строк: %.2f\n", red_result);
     printf("  время: %.4f секунд\n", red_time);
     printf("  ускорение: %.2fx\n", seq_time / red_time);  // вычисляем ускорение
+    numa_print_socket_bandwidth(thread_bw, used_threads);
+    roofline_report(&maximin_kernel, (double)rows * cols, red_time);
+    loop_profile_report(profile);
+    free(thread_bw);
 
-    // параллельная версия с вложенным параллелизмом
-    double nested_result = 0.0;  // переменная для результата
-    double nested_start = omp_get_wtime();  // засекаем время начала
+    // параллельная версия с разбиением на плитки (задачи taskloop)
+    // вместо вложенного parallel for: одна параллельная область, плитки
+    // (блок строк x блок столбцов) - задачи, минимумы строк без критических секций
+    maximin_tiles_t tiles = maximin_tiles_choose(rows, cols, omp_get_max_threads());
+    double tiled_start = omp_get_wtime();  // засекаем время начала
+    double tiled_result = maximin_tiled(&matrix, &tiles);
+    double tiled_time = omp_get_wtime() - tiled_start;  // вычисляем время выполнения
 
-    #pragma omp parallel
-    {
-        double local_max = -1.0;  // локальный максимум для текущего потока
-        
-        // распараллеливаем внешний цикл по строкам
-        #pragma omp for
-        for (int i = 0; i < rows; i++) {
-            double row_min = matrix[i][0];
-            
-            // внутренний цикл тоже распараллеливаем (вложенный параллелизм)
-            #pragma omp parallel for reduction(min:row_min)
-            for (int j = 0; j < cols; j++) {
-                if (matrix[i][j] < row_min) {
-                    row_min = matrix[i][j];  // редукция для нахождения минимума строки
-                }
-            }
-            
-            // обновляем локальный максимум для текущего потока
-            #pragma omp critical
-            {
-                if (row_min > local_max) {
-                    local_max = row_min;
-                }
-            }
+    printf("\nпараллельная версия (плитки, taskloop):\n");
+    printf("  плитка: %ld x %ld, плиток: %ld x %ld\n",
+           tiles.tile_rows, tiles.tile_cols, tiles.row_blocks, tiles.col_blocks);
+    printf("  максимум среди минимумов строк: %.2f\n", tiled_result);
+    printf("  время: %.4f секунд\n", tiled_time);
+    printf("  ускорение: %.2fx\n", seq_time / tiled_time);  // вычисляем ускорение
+    roofline_report(&maximin_kernel, (double)rows * cols, tiled_time);
+
+    // автоматический выбор стратегии по форме матрицы и откалиброванной модели
+    // (для проверки выбора измеряются все три стратегии, лучшее из 3 запусков)
+    maximin_plan_t plan = maximin_plan(rows, cols);
+    double auto_result = 0.0, auto_time = 0.0, best_time = 1e30;
+    maximin_strategy_t best_strategy = MAXIMIN_ROWS;
+    printf("\nпараллельная версия (выбор стратегии по форме матрицы):\n  ");
+    maximin_print_calibration(maximin_calibration());
+    printf("    прогноз, с   измерено, с   стратегия\n");
+    for (int s = MAXIMIN_ROWS; s < MAXIMIN_STRATEGIES; s++) {
+        double r = 0.0, t = 1e30;
+        for (int rep = 0; rep < 3; rep++) {
+            double start = omp_get_wtime();
+            r = maximin_run(&matrix, (maximin_strategy_t)s);
+            double elapsed = omp_get_wtime() - start;
+            if (elapsed < t) t = elapsed;
         }
-        
-        // критическая секция для обновления глобального результата
-        #pragma omp critical
-        {
-            if (local_max > nested_result) {
-                nested_result = local_max;
-            }
+        if (t < best_time) {
+            best_time = t;
+            best_strategy = (maximin_strategy_t)s;
         }
+        if (s == (int)plan.strategy) {
+            auto_result = r;
+            auto_time = t;
+        }
+        // имя стратегии - последним столбцом: ширина поля printf считается в байтах,
+        // и кириллица в utf-8 сбивала бы выравнивание числовых столбцов
+        printf("  %12.6f %13.6f   %s%s\n", plan.predicted[s], t,
+               maximin_strategy_name((maximin_strategy_t)s),
+               s == (int)plan.strategy ? "  <- выбрана" : "");
     }
+    printf("  выбрана: %s%s, прогноз %.6f с, измерено %.6f с (лучшая измеренная: %s)\n",
+           maximin_strategy_name(plan.strategy),
+           plan.forced ? " (MAXIMIN_STRATEGY)" : plan.calibrated ? "" : " (без калибровки)",
+           plan.predicted[plan.strategy], auto_time, maximin_strategy_name(best_strategy));
+    printf("  максимум среди минимумов строк: %.2f\n", auto_result);
+    printf("  ускорение: %.2fx\n", seq_time / auto_time);
 
-    double nested_time = omp_get_wtime() - nested_start;  // вычисляем время выполнения
+    // параллельная версия с отсечением строк (ветви и границы)
+    long visited = 0;
+    double pruned_start = omp_get_wtime();
+    double pruned_result = maximin_pruned(&matrix, &visited);
+    double pruned_time = omp_get_wtime() - pruned_start;
+    double total_elements = (double)rows * cols;
 
-    printf("\nпараллельная версия (вложенный параллелизм):\n");
-    printf("  максимум среди минимумов строк: %.2f\n", nested_result);
-    printf("  время: %.4f секунд\n", nested_time);
-    printf("  ускорение: %.2fx\n", seq_time / nested_time);  // вычисляем ускорение
+    printf("\nпараллельная версия (отсечение строк):\n");
+    printf("  максимум среди минимумов строк: %.2f\n", pruned_result);
+    printf("  время: %.4f секунд\n", pruned_time);
+    printf("  ускорение: %.2fx (относительно редукции: %.2fx)\n", seq_time / pruned_time, red_time / pruned_time);
+    // прочитанные элементы включают выборку: на коротких строках выборка и обход
+    // читают часть элементов дважды, и доля может превысить 100%
+    printf("  прочитано элементов: %.1f%% матрицы (%ld из %.0f, включая выборку %d на строку)\n",
+           100.0 * visited / total_elements, visited, total_elements,
+           cols < MAXIMIN_SAMPLES ? cols : MAXIMIN_SAMPLES);
 
     // проверка корректности результатов всех версий
     printf("\nпроверка корректности:\n");
     printf("  разница (редукция): %.10f\n", fabs(seq_result - red_result));  // сравнение с последовательной версией
-    printf("  разница (вложенный): %.10f\n", fabs(seq_result - nested_result));  // сравнение с последовательной версией
+    printf("  разница (плитки): %.10f\n", fabs(seq_result - tiled_result));  // сравнение с последовательной версией
+    printf("  разница (выбор стратегии): %.10f\n", fabs(seq_result - auto_result));
+    printf("  разница (отсечение): %.10f\n", fabs(seq_result - pruned_result));
+
+    // та же задача на прежней раскладке double** - время выделения и обхода
+    compare_layouts(&matrix);
 
     // освобождаем память
     free(row_minima);  // освобождаем массив минимумов строк
-    for (int i = 0; i < rows; i++) {
-        free(matrix[i]);  // освобождаем каждую строку матрицы
-    }
-    free(matrix);  // освобождаем массив указателей
+    matrix_free(&matrix);  // один буфер на всю матрицу
 
     return 0;
 }
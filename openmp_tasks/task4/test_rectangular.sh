@@ -14,3 +14,11 @@ echo ""
 echo "--- 2000x500 ---"
 OMP_NUM_THREADS=4 ./matrix_min_max 2000 500  # большая прямоугольная матрица
 echo ""
+
+# крайние формы: стратегия выбирается по форме матрицы (строки, столбцы или плитки)
+# (10^7 x 16 и 16 x 10^7 - по 1.3 ГБ; сравнение раскладок выключено, второй копии нет)
+for shape in "16 1000000" "1000000 16" "16 10000000" "10000000 16"; do
+    echo "--- ${shape/ /x} ---"
+    OMP_NUM_THREADS=4 ./matrix_min_max $shape
+    echo ""
+done
@@ -4,6 +4,11 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <unistd.h>
+#include "../../common/philox_rng.h"
+#include "../../common/matrix.h"
+#include "../../common/maximin.h"
+#include "../../common/loop_profile.h"
 
 // типы матриц для экспериментов
 typedef enum {
@@ -14,27 +19,30 @@ typedef enum {
 } MatrixType;
 
 // функция для заполнения матрицы специального типа
-void fill_special_matrix(double **matrix, int size, MatrixType type) {
+// значения берутся из счетчикового генератора philox по номеру элемента i * size + j,
+// поэтому строки заполняются параллельно и матрица не зависит от числа потоков
+// поток 0 генератора - значения элементов, поток 1 - маска разреженности
+void fill_special_matrix(const matrix_t *matrix, int size, MatrixType type, uint64_t seed) {
     switch (type) {
         case DENSE:
             // плотная матрица - все элементы ненулевые
+            #pragma omp parallel for schedule(static)
             for (int i = 0; i < size; i++) {
-                for (int j = 0; j < size; j++) {
-                    matrix[i][j] = (double)rand() / RAND_MAX * 100.0;  // случайные числа 0-100
-                }
+                double *row = matrix_row(matrix, i);
+                rng_fill_range(row, size, seed, 0, (uint64_t)i * size, 0.0, 100.0);  // случайные числа 0-100
             }
             break;
             
         case TRIANGULAR:
             // верхняя треугольная матрица - нули ниже главной диагонали
+            #pragma omp parallel for schedule(static)
             for (int i = 0; i < size; i++) {
-                for (int j = 0; j < size; j++) {
-                    if (j >= i) {  // верхний треугольник включая диагональ
-                        matrix[i][j] = (double)rand() / RAND_MAX * 100.0;
-                    } else {
-                        matrix[i][j] = 0.0;  // нижний треугольник - нули
-                    }
+                double *row = matrix_row(matrix, i);
+                for (int j = 0; j < i; j++) {
+                    row[j] = 0.0;  // нижний треугольник - нули
                 }
+                // верхний треугольник включая диагональ
+                rng_fill_range(row + i, size - i, seed, 0, (uint64_t)i * size + i, 0.0, 100.0);
             }
             break;
             
@@ -42,13 +50,18 @@ void fill_special_matrix(double **matrix, int size, MatrixType type) {
             // ленточная матрица - ненулевые элементы только в полосе вокруг диагонали
             {
                 int bandwidth = size / 10;  // ширина ленты = 10% от размера матрицы
+                #pragma omp parallel for schedule(static)
                 for (int i = 0; i < size; i++) {
-                    for (int j = 0; j < size; j++) {
-                        if (abs(i - j) <= bandwidth) {  // элементы в пределах полосы
-                            matrix[i][j] = (double)rand() / RAND_MAX * 100.0;
-                        } else {
-                            matrix[i][j] = 0.0;  // элементы вне полосы - нули
-                        }
+                    double *row = matrix_row(matrix, i);
+                    int start = (i - bandwidth > 0) ? i - bandwidth : 0;  // начало полосы
+                    int end = (i + bandwidth < size) ? i + bandwidth : size - 1;  // конец полосы
+                    for (int j = 0; j < start; j++) {
+                        row[j] = 0.0;  // элементы вне полосы - нули
+                    }
+                    rng_fill_range(row + start, end - start + 1, seed, 0,
+                                   (uint64_t)i * size + start, 0.0, 100.0);  // элементы в пределах полосы
+                    for (int j = end + 1; j < size; j++) {
+                        row[j] = 0.0;
                     }
                 }
             }
@@ -58,12 +71,14 @@ void fill_special_matrix(double **matrix, int size, MatrixType type) {
             // разреженная матрица - большинство элементов нулевые
             {
                 double sparsity = 0.1;  // только 10% элементов ненулевые (90% нулей)
+                #pragma omp parallel for schedule(static)
                 for (int i = 0; i < size; i++) {
+                    double *row = matrix_row(matrix, i);
+                    rng_fill_range(row, size, seed, 0, (uint64_t)i * size, 0.0, 100.0);
                     for (int j = 0; j < size; j++) {
-                        if ((double)rand() / RAND_MAX > sparsity) {  // с вероятностью 10% создаем ненулевой элемент
-                            matrix[i][j] = (double)rand() / RAND_MAX * 100.0;
-                        } else {
-                            matrix[i][j] = 0.0;  // 90% элементов - нули
+                        // с вероятностью 10% оставляем ненулевой элемент
+                        if (rng_uniform_at(seed, 1, (uint64_t)i * size + j) >= sparsity) {
+                            row[j] = 0.0;  // 90% элементов - нули
                         }
                     }
                 }
@@ -73,17 +88,21 @@ void fill_special_matrix(double **matrix, int size, MatrixType type) {
 }
 
 // функция для поиска максимума среди минимумов строк с разными schedule
-double find_max_of_row_minima(double **matrix, int size, MatrixType type, const char* schedule_type) {
+// profile - профиль дисбаланса по потокам (loop_profile_begin) или NULL
+double find_max_of_row_minima(const matrix_t *matrix, int size, MatrixType type, const char* schedule_type,
+                              loop_profile_t *profile) {
     double result = -1.0;  // инициализируем результат
     
     #pragma omp parallel
     {
         double local_max = -1.0;  // локальный максимум для каждого потока
+        loop_probe_t probe = loop_probe_start(profile);
         
         // статическое распределение итераций - равные блоки для каждого потока
         if (strcmp(schedule_type, "static") == 0) {
-            #pragma omp for schedule(static)
-            for (int i = 0; i < size; i++) {
+            LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait", (int i = 0; i < size; i++), i,
+                             LOOP_CHUNK_STATIC,
+                const double *row = matrix_row(matrix, i);
                 double row_min = 1e9;  // большое начальное значение для поиска минимума
                 
                 // для разных типов матриц - разная вычислительная нагрузка на строку
@@ -91,8 +110,8 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                     case DENSE:
                         // плотная матрица - проверяем все элементы строки
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min && row[j] != 0.0) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -100,8 +119,8 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                     case TRIANGULAR:
                         // треугольная матрица - проверяем только верхний треугольник
                         for (int j = i; j < size; j++) {  // начинаем с диагонали
-                            if (matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -113,8 +132,8 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                             int start = (i - bandwidth > 0) ? i - bandwidth : 0;  // начало полосы
                             int end = (i + bandwidth < size) ? i + bandwidth : size - 1;  // конец полосы
                             for (int j = start; j <= end; j++) {
-                                if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                    row_min = matrix[i][j];
+                                if (row[j] < row_min && row[j] != 0.0) {
+                                    row_min = row[j];
                                 }
                             }
                         }
@@ -123,8 +142,8 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                     case SPARSE:
                         // разреженная матрица - проверяем только ненулевые элементы
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] != 0.0 && matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] != 0.0 && row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -134,26 +153,28 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                 if (row_min > local_max && row_min < 1e9) {
                     local_max = row_min;
                 }
-            }
+            );
         }
         // динамическое распределение - потоки берут небольшие порции итераций
         else if (strcmp(schedule_type, "dynamic") == 0) {
-            #pragma omp for schedule(dynamic, 10)  // chunk size = 10 итераций
-            for (int i = 0; i < size; i++) {
+            // chunk size = 10 итераций
+            LOOP_PROFILE_FOR(&probe, "omp for schedule(dynamic, 10) nowait", (int i = 0; i < size; i++), i,
+                             10,
+                const double *row = matrix_row(matrix, i);
                 double row_min = 1e9;
                 // аналогичный код обработки строк для разных типов матриц
                 switch (type) {
                     case DENSE:
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min && row[j] != 0.0) {
+                                row_min = row[j];
                             }
                         }
                         break;
                     case TRIANGULAR:
                         for (int j = i; j < size; j++) {
-                            if (matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -163,16 +184,16 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                             int start = (i - bandwidth > 0) ? i - bandwidth : 0;
                             int end = (i + bandwidth < size) ? i + bandwidth : size - 1;
                             for (int j = start; j <= end; j++) {
-                                if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                    row_min = matrix[i][j];
+                                if (row[j] < row_min && row[j] != 0.0) {
+                                    row_min = row[j];
                                 }
                             }
                         }
                         break;
                     case SPARSE:
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] != 0.0 && matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] != 0.0 && row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -181,26 +202,28 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                 if (row_min > local_max && row_min < 1e9) {
                     local_max = row_min;
                 }
-            }
+            );
         }
         // guided распределение - размер порций уменьшается по мере выполнения
         else if (strcmp(schedule_type, "guided") == 0) {
-            #pragma omp for schedule(guided)  // размер chunk уменьшается экспоненциально
-            for (int i = 0; i < size; i++) {
+            // размер chunk уменьшается экспоненциально
+            LOOP_PROFILE_FOR(&probe, "omp for schedule(guided) nowait", (int i = 0; i < size; i++), i,
+                             LOOP_CHUNK_UNKNOWN,
+                const double *row = matrix_row(matrix, i);
                 double row_min = 1e9;
                 // аналогичный код обработки строк для разных типов матриц
                 switch (type) {
                     case DENSE:
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min && row[j] != 0.0) {
+                                row_min = row[j];
                             }
                         }
                         break;
                     case TRIANGULAR:
                         for (int j = i; j < size; j++) {
-                            if (matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -210,16 +233,16 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                             int start = (i - bandwidth > 0) ? i - bandwidth : 0;
                             int end = (i + bandwidth < size) ? i + bandwidth : size - 1;
                             for (int j = start; j <= end; j++) {
-                                if (matrix[i][j] < row_min && matrix[i][j] != 0.0) {
-                                    row_min = matrix[i][j];
+                                if (row[j] < row_min && row[j] != 0.0) {
+                                    row_min = row[j];
                                 }
                             }
                         }
                         break;
                     case SPARSE:
                         for (int j = 0; j < size; j++) {
-                            if (matrix[i][j] != 0.0 && matrix[i][j] < row_min) {
-                                row_min = matrix[i][j];
+                            if (row[j] != 0.0 && row[j] < row_min) {
+                                row_min = row[j];
                             }
                         }
                         break;
@@ -228,8 +251,10 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
                 if (row_min > local_max && row_min < 1e9) {
                     local_max = row_min;
                 }
-            }
+            );
         }
+        // барьер вместо неявного у omp for (и замер ожидания на нем)
+        loop_probe_finish(profile, &probe);
         
         // критическая секция для безопасного обновления глобального результата
         #pragma omp critical
@@ -243,16 +268,703 @@ double find_max_of_row_minima(double **matrix, int size, MatrixType type, const
     return result;
 }
 
+// специализированные ядра: отдельная функция на каждую пару (тип матрицы, schedule)
+// find_max_of_row_minima сравнивает строку schedule через strcmp и внутри параллельной
+// области для каждой строки выбирает ветку switch по типу, а проверка != 0.0 на каждом
+// элементе мешает векторизации. здесь тип и schedule выбираются один раз до
+// параллельной области (special_kernel), а тело цикла по строке - без ветвлений:
+// - DENSE, TRIANGULAR, BANDED: элементы в пределах структуры берутся из [0, 100)
+//   и нулями не бывают, поэтому просматриваются без проверки (maximin_block_min)
+// - SPARSE (плотное хранение): нули структурные - заменяются на 1e9 выбором без ветвления
+static inline double row_min_dense(const double *row, int i, int size) {
+    (void)i;
+    return maximin_block_min(row, size, 1e9);
+}
+
+static inline double row_min_triangular(const double *row, int i, int size) {
+    return maximin_block_min(row + i, size - i, 1e9);
+}
+
+static inline double row_min_banded(const double *row, int i, int size) {
+    int bandwidth = size / 10;
+    int start = (i - bandwidth > 0) ? i - bandwidth : 0;
+    int end = (i + bandwidth < size) ? i + bandwidth : size - 1;
+    return maximin_block_min(row + start, end - start + 1, 1e9);
+}
+
+static inline double row_min_sparse(const double *row, int i, int size) {
+    (void)i;
+    double m0 = 1e9, m1 = 1e9, m2 = 1e9, m3 = 1e9;
+    int j = 0;
+    for (; j + 4 <= size; j += 4) {
+        double v0 = row[j] == 0.0 ? 1e9 : row[j];
+        double v1 = row[j + 1] == 0.0 ? 1e9 : row[j + 1];
+        double v2 = row[j + 2] == 0.0 ? 1e9 : row[j + 2];
+        double v3 = row[j + 3] == 0.0 ? 1e9 : row[j + 3];
+        m0 = v0 < m0 ? v0 : m0;
+        m1 = v1 < m1 ? v1 : m1;
+        m2 = v2 < m2 ? v2 : m2;
+        m3 = v3 < m3 ? v3 : m3;
+    }
+    for (; j < size; j++) {
+        double v = row[j] == 0.0 ? 1e9 : row[j];
+        m0 = v < m0 ? v : m0;
+    }
+    m0 = m1 < m0 ? m1 : m0;
+    m2 = m3 < m2 ? m3 : m2;
+    return m2 < m0 ? m2 : m0;
+}
+
+// для отдельного столбца отчета: циклы по строке из веток switch общего ядра
+// (с проверкой != 0.0) - ядра dispatch_<тип>_<schedule> на них отличаются от
+// общего ядра только выбором вне цикла
+static inline double row_scan_dense(const double *row, int i, int size) {
+    (void)i;
+    double row_min = 1e9;
+    for (int j = 0; j < size; j++) {
+        if (row[j] < row_min && row[j] != 0.0) {
+            row_min = row[j];
+        }
+    }
+    return row_min;
+}
+
+static inline double row_scan_triangular(const double *row, int i, int size) {
+    double row_min = 1e9;
+    for (int j = i; j < size; j++) {
+        if (row[j] < row_min) {
+            row_min = row[j];
+        }
+    }
+    return row_min;
+}
+
+static inline double row_scan_banded(const double *row, int i, int size) {
+    double row_min = 1e9;
+    int bandwidth = size / 10;
+    int start = (i - bandwidth > 0) ? i - bandwidth : 0;
+    int end = (i + bandwidth < size) ? i + bandwidth : size - 1;
+    for (int j = start; j <= end; j++) {
+        if (row[j] < row_min && row[j] != 0.0) {
+            row_min = row[j];
+        }
+    }
+    return row_min;
+}
+
+static inline double row_scan_sparse(const double *row, int i, int size) {
+    (void)i;
+    double row_min = 1e9;
+    for (int j = 0; j < size; j++) {
+        if (row[j] != 0.0 && row[j] < row_min) {
+            row_min = row[j];
+        }
+    }
+    return row_min;
+}
+
+// ядро <kernel>_<тип>_<schedule> на строках <row>_<тип>: один параллельный цикл,
+// редукция max без critical
+#define SPECIAL_KERNEL(kernel, row, type, sched, directive) \
+    static double kernel##_##type##_##sched(const matrix_t *matrix, int size) { \
+        double result = -1.0; \
+        _Pragma(directive) \
+        for (int i = 0; i < size; i++) { \
+            double row_min = row##_##type(matrix_row(matrix, i), i, size); \
+            if (row_min > result && row_min < 1e9) result = row_min; \
+        } \
+        return result; \
+    }
+
+#define SPECIAL_KERNELS(kernel, row, type) \
+    SPECIAL_KERNEL(kernel, row, type, static, "omp parallel for schedule(static) reduction(max:result)") \
+    SPECIAL_KERNEL(kernel, row, type, dynamic, "omp parallel for schedule(dynamic, 10) reduction(max:result)") \
+    SPECIAL_KERNEL(kernel, row, type, guided, "omp parallel for schedule(guided) reduction(max:result)")
+
+SPECIAL_KERNELS(maximin, row_min, dense)
+SPECIAL_KERNELS(maximin, row_min, triangular)
+SPECIAL_KERNELS(maximin, row_min, banded)
+SPECIAL_KERNELS(maximin, row_min, sparse)
+SPECIAL_KERNELS(dispatch, row_scan, dense)
+SPECIAL_KERNELS(dispatch, row_scan, triangular)
+SPECIAL_KERNELS(dispatch, row_scan, banded)
+SPECIAL_KERNELS(dispatch, row_scan, sparse)
+
+typedef double (*special_kernel_t)(const matrix_t *matrix, int size);
+
+// [тип][schedule] в порядке MatrixType и static, dynamic, guided
+static const special_kernel_t special_kernels[4][3] = {
+    {maximin_dense_static, maximin_dense_dynamic, maximin_dense_guided},
+    {maximin_triangular_static, maximin_triangular_dynamic, maximin_triangular_guided},
+    {maximin_banded_static, maximin_banded_dynamic, maximin_banded_guided},
+    {maximin_sparse_static, maximin_sparse_dynamic, maximin_sparse_guided}
+};
+
+static const special_kernel_t dispatch_kernels[4][3] = {
+    {dispatch_dense_static, dispatch_dense_dynamic, dispatch_dense_guided},
+    {dispatch_triangular_static, dispatch_triangular_dynamic, dispatch_triangular_guided},
+    {dispatch_banded_static, dispatch_banded_dynamic, dispatch_banded_guided},
+    {dispatch_sparse_static, dispatch_sparse_dynamic, dispatch_sparse_guided}
+};
+
+// выбор ядра один раз, до параллельной области; NULL - неизвестный schedule
+// scan_only - ядро с циклом по строке из общего ядра (только выбор вне цикла)
+special_kernel_t special_kernel(MatrixType type, const char *schedule_type, int scan_only) {
+    static const char *names[3] = {"static", "dynamic", "guided"};
+    for (int s = 0; s < 3; s++) {
+        if (strcmp(schedule_type, names[s]) == 0) {
+            return scan_only ? dispatch_kernels[type][s] : special_kernels[type][s];
+        }
+    }
+    return NULL;
+}
+
+// компактное хранение специальных матриц: хранятся только элементы, которые
+// может прочитать maximin (для плотной версии это элементы структуры и ненули)
+// - TRIANGULAR: упакованный верхний треугольник, строка i - size - i элементов
+//   начиная со смещения i * size - i * (i - 1) / 2
+// - BANDED: ленточное хранение, строка i - 2 * bandwidth + 1 ячеек для столбцов
+//   i - bandwidth .. i + bandwidth (ячейки за краем матрицы не используются)
+// - SPARSE: csr - смещения строк row_ptr, номера столбцов col_idx, значения values
+typedef enum {
+    STORAGE_DENSE,
+    STORAGE_PACKED_UPPER,
+    STORAGE_BAND,
+    STORAGE_CSR
+} StorageFormat;
+
+typedef struct {
+    StorageFormat format;
+    int size;
+    int bandwidth;     // BAND: ширина ленты по одну сторону от диагонали
+    double *values;    // PACKED_UPPER, BAND, CSR
+    long *row_ptr;     // CSR: size + 1 смещений строк в values
+    int *col_idx;      // CSR: столбец каждого значения
+    long nnz;          // хранимых элементов
+    matrix_t dense;    // DENSE: представление плотной матрицы (не владеет буфером)
+} StoredMatrix;
+
+static inline long packed_row_offset(long i, long size) {
+    return i * size - i * (i - 1) / 2;
+}
+
+// первый и последний столбец ленты строки i (как в плотной версии)
+static inline void band_columns(int i, int size, int bandwidth, int *start, int *end) {
+    *start = (i - bandwidth > 0) ? i - bandwidth : 0;
+    *end = (i + bandwidth < size) ? i + bandwidth : size - 1;
+}
+
+// байт памяти под хранение
+static long stored_matrix_bytes(const StoredMatrix *sm) {
+    switch (sm->format) {
+        case STORAGE_CSR:
+            return sm->nnz * (long)(sizeof(double) + sizeof(int)) + (sm->size + 1L) * (long)sizeof(long);
+        case STORAGE_DENSE:
+            return sm->dense.rows * sm->dense.ld * (long)sizeof(double);
+        default:
+            return sm->nnz * (long)sizeof(double);
+    }
+}
+
+static const char *storage_name(StorageFormat format) {
+    switch (format) {
+        case STORAGE_PACKED_UPPER: return "упакованный треугольник";
+        case STORAGE_BAND:         return "лента";
+        case STORAGE_CSR:          return "csr";
+        default:                   return "плотное";
+    }
+}
+
+// освобождение и обнуление; обнуленная структура (size == 0) - признак того, что
+// построителю не хватило памяти
+void free_stored_matrix(StoredMatrix *sm) {
+    free(sm->values);
+    free(sm->row_ptr);
+    free(sm->col_idx);
+    memset(sm, 0, sizeof(*sm));
+}
+
+// разреженная матрица сразу в csr, без плотного массива (n = 50000: 20 ГБ плотно
+// против 3 ГБ в csr). два параллельных прохода по строкам:
+// 1. маска строки (поток 1 philox) блоками rng_fill_range во временную строку потока,
+//    подсчет ненулей строки
+// 2. префиксная сумма дает смещения строк, маска строки вычисляется заново и ненули
+//    пишутся на свои места (значения - поток 0, как в fill_special_matrix)
+// счетчиковый генератор не хранит состояния, поэтому второй проход воспроизводит
+// маску первого без ее хранения; память - csr и одна строка на поток.
+// при нехватке памяти - обнуленная структура
+StoredMatrix generate_csr(int size, uint64_t seed, double sparsity) {
+    StoredMatrix sm;
+    memset(&sm, 0, sizeof(sm));
+    sm.format = STORAGE_CSR;
+    sm.size = size;
+    sm.row_ptr = (long*)malloc((size + 1L) * sizeof(long));
+    if (sm.row_ptr == NULL) {
+        free_stored_matrix(&sm);
+        return sm;
+    }
+    sm.row_ptr[0] = 0;
+    int failed = 0;  // какому-то потоку не хватило памяти - проходы пропускаются
+
+    #pragma omp parallel
+    {
+        double *mask = (double*)malloc(size * sizeof(double));  // маска текущей строки
+        if (mask == NULL) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+        #pragma omp for schedule(static)
+        for (int i = 0; i < size; i++) {
+            if (mask == NULL) continue;
+            rng_fill_range(mask, size, seed, 1, (uint64_t)i * size, 0.0, 1.0);
+            long count = 0;
+            for (int j = 0; j < size; j++) {
+                count += mask[j] < sparsity;
+            }
+            sm.row_ptr[i + 1] = count;
+        }
+        // конец цикла - барьер: все счетчики записаны
+
+        #pragma omp single
+        if (!failed) {
+            for (int i = 0; i < size; i++) {
+                sm.row_ptr[i + 1] += sm.row_ptr[i];
+            }
+            sm.nnz = sm.row_ptr[size];
+            sm.values = (double*)malloc(sm.nnz * sizeof(double));
+            sm.col_idx = (int*)malloc(sm.nnz * sizeof(int));
+            if (sm.values == NULL || sm.col_idx == NULL) failed = 1;
+        }
+        // конец single - барьер: смещения и буферы готовы, failed одинаков у всех потоков
+
+        if (!failed) {
+            #pragma omp for schedule(static)
+            for (int i = 0; i < size; i++) {
+                rng_fill_range(mask, size, seed, 1, (uint64_t)i * size, 0.0, 1.0);
+                long k = sm.row_ptr[i];
+                for (int j = 0; j < size; j++) {
+                    if (mask[j] < sparsity) {
+                        sm.col_idx[k] = j;
+                        sm.values[k] = 100.0 * rng_uniform_at(seed, 0, (uint64_t)i * size + j);
+                        k++;
+                    }
+                }
+            }
+        }
+        free(mask);
+    }
+    if (failed) free_stored_matrix(&sm);
+    return sm;
+}
+
+// генерация сразу в компактный формат: те же элементы philox (номер i * size + j),
+// что и у fill_special_matrix, поэтому результаты maximin совпадают с плотной версией.
+// строки заполняются параллельно; у треугольной и разреженной матрицы строки разной
+// длины, поэтому schedule(dynamic). при нехватке памяти - обнуленная структура
+StoredMatrix generate_stored_matrix(int size, MatrixType type, uint64_t seed) {
+    StoredMatrix sm;
+    memset(&sm, 0, sizeof(sm));
+    sm.size = size;
+
+    switch (type) {
+        case TRIANGULAR:
+            sm.format = STORAGE_PACKED_UPPER;
+            sm.nnz = (long)size * (size + 1) / 2;
+            sm.values = (double*)malloc(sm.nnz * sizeof(double));
+            if (sm.values == NULL) {
+                free_stored_matrix(&sm);
+                break;
+            }
+            #pragma omp parallel for schedule(dynamic, 16)
+            for (int i = 0; i < size; i++) {
+                rng_fill_range(sm.values + packed_row_offset(i, size), size - i, seed, 0,
+                               (uint64_t)i * size + i, 0.0, 100.0);
+            }
+            break;
+
+        case BANDED:
+            {
+                sm.format = STORAGE_BAND;
+                sm.bandwidth = size / 10;  // как в fill_special_matrix
+                long width = 2L * sm.bandwidth + 1;
+                sm.nnz = (long)size * width;
+                sm.values = (double*)malloc(sm.nnz * sizeof(double));
+                if (sm.values == NULL) {
+                    free_stored_matrix(&sm);
+                    break;
+                }
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < size; i++) {
+                    int start, end;
+                    band_columns(i, size, sm.bandwidth, &start, &end);
+                    // ячейка k строки i - столбец i - bandwidth + k
+                    double *row = sm.values + i * width + (start - (i - sm.bandwidth));
+                    rng_fill_range(row, end - start + 1, seed, 0, (uint64_t)i * size + start, 0.0, 100.0);
+                }
+            }
+            break;
+
+        case SPARSE:
+            sm = generate_csr(size, seed, 0.1);
+            break;
+
+        default:
+            sm.format = STORAGE_DENSE;  // плотная матрица хранится как есть (matrix_t)
+            break;
+    }
+    return sm;
+}
+
+// минимум строки i в компактном хранении; просматриваются только хранимые элементы,
+// поэтому время пропорционально nnz, а не size * size
+static inline double stored_row_min(const StoredMatrix *sm, int i) {
+    const double *v;
+    long len;
+    switch (sm->format) {
+        case STORAGE_PACKED_UPPER:
+            v = sm->values + packed_row_offset(i, sm->size);
+            len = sm->size - i;
+            break;
+        case STORAGE_BAND:
+            {
+                int start, end;
+                band_columns(i, sm->size, sm->bandwidth, &start, &end);
+                v = sm->values + i * (2L * sm->bandwidth + 1) + (start - (i - sm->bandwidth));
+                len = end - start + 1;
+            }
+            break;
+        case STORAGE_CSR:
+            v = sm->values + sm->row_ptr[i];
+            len = sm->row_ptr[i + 1] - sm->row_ptr[i];
+            break;
+        default:
+            // плотное хранение: нули - отсутствующие элементы, пропускаются без ветвления
+            return row_min_sparse(matrix_row(&sm->dense, i), i, sm->size);
+    }
+    double row_min = 1e9;  // строка без элементов не участвует (как в плотной версии)
+    for (long j = 0; j < len; j++) {
+        if (v[j] < row_min) {
+            row_min = v[j];
+        }
+    }
+    return row_min;
+}
+
+// максимум среди минимумов строк по компактному хранению с разными schedule
+double find_max_of_row_minima_stored(const StoredMatrix *sm, const char *schedule_type) {
+    double result = -1.0;
+    int size = sm->size;
+
+    if (strcmp(schedule_type, "static") == 0) {
+        #pragma omp parallel for schedule(static) reduction(max:result)
+        for (int i = 0; i < size; i++) {
+            double row_min = stored_row_min(sm, i);
+            if (row_min > result && row_min < 1e9) result = row_min;
+        }
+    } else if (strcmp(schedule_type, "dynamic") == 0) {
+        #pragma omp parallel for schedule(dynamic, 10) reduction(max:result)
+        for (int i = 0; i < size; i++) {
+            double row_min = stored_row_min(sm, i);
+            if (row_min > result && row_min < 1e9) result = row_min;
+        }
+    } else if (strcmp(schedule_type, "guided") == 0) {
+        #pragma omp parallel for schedule(guided) reduction(max:result)
+        for (int i = 0; i < size; i++) {
+            double row_min = stored_row_min(sm, i);
+            if (row_min > result && row_min < 1e9) result = row_min;
+        }
+    }
+    return result;
+}
+
+// автоопределение структуры матрицы без указания MatrixType
+//
+// maximin без типа - максимум по строкам минимума ненулевых элементов строки.
+// 1. выборка: DETECT_SAMPLE_ROWS строк с равным шагом просматриваются целиком
+//    (параллельно), по ним - первый и последний ненуль относительно диагонали и плотность
+// 2. выбор формата: ненулей ниже диагонали нет - упакованный треугольник; ненули
+//    в узкой полосе - лента; мало ненулей - csr; иначе плотное хранение
+// 3. преобразование за один параллельный проход с точной проверкой: ненуль вне
+//    выбранной структуры (выборка могла его пропустить) - откат на csr или плотное
+//    хранение; нули внутри структуры хранятся как 1e9 и в минимум не попадают
+// стоимость (выборка + преобразование) окупается, если одну матрицу опрашивают многократно
+#define DETECT_SAMPLE_ROWS 64
+#define DETECT_SPARSE_DENSITY 0.3   // ниже - csr (12 байт на ненуль против 8 на элемент)
+#define DETECT_STRUCTURE_FILL 0.5   // треугольник/лента - если внутри заполнены хотя бы наполовину
+
+typedef struct {
+    int upper;            // в выборке нет ненулей ниже диагонали
+    int bandwidth;        // наибольшее |j - i| ненуля в выборке
+    double density;       // доля ненулей в выборке
+    long lower_nonzeros;  // ненулей ниже диагонали в выборке
+    int sampled_rows;
+} MatrixStructure;
+
+MatrixStructure detect_structure(const matrix_t *matrix) {
+    MatrixStructure st;
+    int size = (int)matrix->rows;
+    int samples = size < DETECT_SAMPLE_ROWS ? size : DETECT_SAMPLE_ROWS;
+    long nonzeros = 0, lower = 0;
+    int bandwidth = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:nonzeros, lower) reduction(max:bandwidth)
+    for (int k = 0; k < samples; k++) {
+        int i = (int)((long)k * size / samples);
+        const double *row = matrix_row(matrix, i);
+        int first = -1, last = -1;
+        long count = 0;
+        for (int j = 0; j < size; j++) {
+            if (row[j] != 0.0) {
+                if (first < 0) first = j;
+                last = j;
+                count++;
+            }
+        }
+        nonzeros += count;
+        if (first >= 0) {
+            for (int j = first; j < i; j++) lower += row[j] != 0.0;
+            int reach = (i - first > last - i) ? i - first : last - i;
+            if (reach > bandwidth) bandwidth = reach;
+        }
+    }
+
+    st.sampled_rows = samples;
+    st.lower_nonzeros = lower;
+    st.upper = lower == 0;
+    st.bandwidth = bandwidth;
+    st.density = (double)nonzeros / ((double)samples * size);
+    return st;
+}
+
+// формат по выборке: сравниваются заполненность структуры и плотность
+StorageFormat choose_storage(const MatrixStructure *st, int size) {
+    // доля матрицы, которую занимает структура
+    double upper_share = 0.5 * (size + 1.0) / size;
+    double band_share = (2.0 * st->bandwidth + 1.0) / size;
+    if (st->upper && st->density / upper_share >= DETECT_STRUCTURE_FILL) return STORAGE_PACKED_UPPER;
+    if (band_share < 0.5 && st->density / band_share >= DETECT_STRUCTURE_FILL) return STORAGE_BAND;
+    if (st->density < DETECT_SPARSE_DENSITY) return STORAGE_CSR;
+    return STORAGE_DENSE;
+}
+
+// плотная матрица в csr (два прохода: подсчет ненулей строк, заполнение);
+// при нехватке памяти - обнуленная структура
+StoredMatrix dense_to_csr(const matrix_t *matrix) {
+    StoredMatrix sm;
+    memset(&sm, 0, sizeof(sm));
+    int size = (int)matrix->rows;
+    sm.format = STORAGE_CSR;
+    sm.size = size;
+    sm.row_ptr = (long*)malloc((size + 1L) * sizeof(long));
+    if (sm.row_ptr == NULL) {
+        free_stored_matrix(&sm);
+        return sm;
+    }
+    sm.row_ptr[0] = 0;
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < size; i++) {
+        const double *row = matrix_row(matrix, i);
+        long count = 0;
+        for (int j = 0; j < size; j++) count += row[j] != 0.0;
+        sm.row_ptr[i + 1] = count;
+    }
+    for (int i = 0; i < size; i++) sm.row_ptr[i + 1] += sm.row_ptr[i];
+    sm.nnz = sm.row_ptr[size];
+    sm.values = (double*)malloc(sm.nnz * sizeof(double));
+    sm.col_idx = (int*)malloc(sm.nnz * sizeof(int));
+    if (sm.values == NULL || sm.col_idx == NULL) {
+        free_stored_matrix(&sm);
+        return sm;
+    }
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < size; i++) {
+        const double *row = matrix_row(matrix, i);
+        long k = sm.row_ptr[i];
+        for (int j = 0; j < size; j++) {
+            if (row[j] != 0.0) {
+                sm.col_idx[k] = j;
+                sm.values[k] = row[j];
+                k++;
+            }
+        }
+    }
+    return sm;
+}
+
+// плотная матрица в упакованный треугольник или ленту; *violations - ненулей
+// вне структуры (при > 0 результат непригоден и освобождается). при нехватке
+// памяти - обнуленная структура и *violations = 0
+StoredMatrix dense_to_structured(const matrix_t *matrix, StorageFormat format, int bandwidth,
+                                 long *violations) {
+    StoredMatrix sm;
+    memset(&sm, 0, sizeof(sm));
+    int size = (int)matrix->rows;
+    long outside = 0;
+    sm.format = format;
+    sm.size = size;
+    sm.bandwidth = bandwidth;
+    long width = 2L * bandwidth + 1;
+    sm.nnz = format == STORAGE_PACKED_UPPER ? (long)size * (size + 1) / 2 : (long)size * width;
+    sm.values = (double*)malloc(sm.nnz * sizeof(double));
+    *violations = 0;
+    if (sm.values == NULL) {
+        free_stored_matrix(&sm);
+        return sm;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:outside)
+    for (int i = 0; i < size; i++) {
+        const double *row = matrix_row(matrix, i);
+        int start, end;
+        double *dst;
+        if (format == STORAGE_PACKED_UPPER) {
+            start = i;
+            end = size - 1;
+            dst = sm.values + packed_row_offset(i, size);
+        } else {
+            band_columns(i, size, bandwidth, &start, &end);
+            dst = sm.values + i * width + (start - (i - bandwidth));
+        }
+        for (int j = 0; j < start; j++) outside += row[j] != 0.0;
+        for (int j = end + 1; j < size; j++) outside += row[j] != 0.0;
+        for (int j = start; j <= end; j++) {
+            dst[j - start] = row[j] == 0.0 ? 1e9 : row[j];  // нуль - отсутствующий элемент
+        }
+    }
+
+    *violations = outside;
+    if (outside > 0) free_stored_matrix(&sm);
+    return sm;
+}
+
+// выборка, выбор формата и преобразование; *fallback - проверка отвергла выбор по выборке.
+// при нехватке памяти - обнуленная структура
+StoredMatrix convert_detected(const matrix_t *matrix, const MatrixStructure *st, int *fallback) {
+    int size = (int)matrix->rows;
+    StorageFormat format = choose_storage(st, size);
+    *fallback = 0;
+    if (format == STORAGE_PACKED_UPPER || format == STORAGE_BAND) {
+        long violations = 0;
+        StoredMatrix sm = dense_to_structured(matrix, format, st->bandwidth, &violations);
+        if (violations == 0) return sm;
+        *fallback = 1;
+        format = st->density < DETECT_SPARSE_DENSITY ? STORAGE_CSR : STORAGE_DENSE;
+    }
+    if (format == STORAGE_CSR) return dense_to_csr(matrix);
+
+    StoredMatrix sm;  // плотное хранение - представление исходной матрицы
+    memset(&sm, 0, sizeof(sm));
+    sm.format = STORAGE_DENSE;
+    sm.size = size;
+    sm.dense = matrix_block(matrix, 0, 0, matrix->rows, matrix->cols);
+    sm.nnz = (long)size * size;
+    return sm;
+}
+
+// пиковый резидентный объем процесса (VmHWM из /proc/self/status), МБ; -1 - нет данных
+static double peak_rss_mb(void) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f == NULL) return -1.0;
+    char line[256];
+    double kb = -1.0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            kb = atof(line + 6);
+            break;
+        }
+    }
+    fclose(f);
+    return kb < 0.0 ? -1.0 : kb / 1024.0;
+}
+
+// сброс пика до текущего объема (linux 4.0+: запись 5 в /proc/self/clear_refs),
+// чтобы пик измерялся для каждого пути отдельно; 0 - сброс недоступен
+static int reset_peak_rss(void) {
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f == NULL) return 0;
+    int ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+// режим "csr": разреженная матрица без плотного массива против прежнего плотного пути
+// (заполнение n x n и обнуление 90%). плотный путь выполняется, только если n * n
+// double занимают меньше половины физической памяти
+int run_sparse_generation(int size, uint64_t seed) {
+    double dense_mb = (double)size * matrix_padded_ld(size) * sizeof(double) / 1048576.0;
+    double phys_mb = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) / 1048576.0;
+    printf("разреженная матрица %d x %d (10%% ненулей): прямая генерация csr против плотной\n", size, size);
+    printf("потоков: %d, физической памяти: %.0f МБ\n\n", omp_get_max_threads(), phys_mb);
+
+    int separate = reset_peak_rss();
+    double rss_before = peak_rss_mb();
+    double start = omp_get_wtime();
+    StoredMatrix csr = generate_csr(size, seed, 0.1);
+    double csr_gen_time = omp_get_wtime() - start;
+    if (csr.size == 0) {
+        printf("не удалось выделить память под csr %d x %d\n", size, size);
+        return 1;
+    }
+    start = omp_get_wtime();
+    double csr_result = find_max_of_row_minima_stored(&csr, "static");
+    double csr_time = omp_get_wtime() - start;
+    double csr_peak = peak_rss_mb();
+
+    printf("csr (два прохода, без плотного массива):\n");
+    printf("  ненулей: %ld, хранение: %.1f МБ\n", csr.nnz, stored_matrix_bytes(&csr) / 1048576.0);
+    printf("  генерация: %.4f сек, maximin: %.4f сек, результат: %.2f\n", csr_gen_time, csr_time, csr_result);
+    printf("  пиковый rss: %.1f МБ (до генерации %.1f МБ)\n", csr_peak, rss_before);
+    free_stored_matrix(&csr);
+
+    if (dense_mb > phys_mb / 2) {
+        printf("\nплотный путь пропущен: нужно %.0f МБ при %.0f МБ памяти\n", dense_mb, phys_mb);
+        return 0;
+    }
+    if (!separate) {
+        printf("\n(сброс пика недоступен: пик плотного пути включает пик csr)\n");
+    }
+    reset_peak_rss();
+    start = omp_get_wtime();
+    matrix_t dense = matrix_alloc(size, size);
+    if (dense.data == NULL) {
+        printf("\nне удалось выделить %.0f МБ под плотную матрицу\n", dense_mb);
+        return 0;
+    }
+    fill_special_matrix(&dense, size, SPARSE, seed);
+    double dense_gen_time = omp_get_wtime() - start;
+    start = omp_get_wtime();
+    double dense_result = find_max_of_row_minima(&dense, size, SPARSE, "static", NULL);
+    double dense_time = omp_get_wtime() - start;
+    double dense_peak = peak_rss_mb();
+    matrix_free(&dense);
+
+    printf("\nплотный путь (n x n, затем обнуление 90%%):\n");
+    printf("  хранение: %.1f МБ\n", dense_mb);
+    printf("  генерация: %.4f сек, maximin: %.4f сек, результат: %.2f\n", dense_gen_time, dense_time, dense_result);
+    printf("  пиковый rss: %.1f МБ\n", dense_peak);
+    printf("\ncsr: генерация в %.2f раза быстрее, пик памяти в %.1f раза меньше, разница результатов %.10f\n",
+           dense_gen_time / csr_gen_time, dense_peak / csr_peak, fabs(dense_result - csr_result));
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     int size = 2000;  // размер матрицы по умолчанию
     if (argc > 1) {
         size = atoi(argv[1]);  // можно передать размер как аргумент
     }
+    if (size < 1) {
+        printf("размер матрицы должен быть положительным\n");
+        return 1;
+    }
+    // второй аргумент csr - только разреженная матрица, csr против плотного пути
+    if (argc > 2 && strcmp(argv[2], "csr") == 0) {
+        return run_sparse_generation(size, rng_seed_from_env());
+    }
 
-    // выделяем память под матрицу
-    double **matrix = (double**)malloc(size * sizeof(double*));
-    for (int i = 0; i < size; i++) {
-        matrix[i] = (double*)malloc(size * sizeof(double));
+    // выделяем память под матрицу: один выровненный буфер вместо malloc на строку
+    matrix_t matrix = matrix_alloc(size, size);
+    if (matrix.data == NULL) {
+        printf("не удалось выделить память под матрицу %d x %d\n", size, size);
+        return 1;
     }
 
     // типы матриц для тестирования
@@ -262,7 +974,7 @@ int main(int argc, char *argv[]) {
     // типы распределения итераций между потоками
     const char* schedules[] = {"static", "dynamic", "guided"};
     
-    srand(time(NULL));  // инициализация генератора случайных чисел
+    uint64_t seed = rng_seed_from_env();  // фиксированный seed или RNG_SEED - данные воспроизводимы
 
     printf("исследование специальных типов матриц и распределения итераций\n");
     printf("размер матрицы: %d x %d\n\n", size, size);
@@ -272,34 +984,140 @@ int main(int argc, char *argv[]) {
         MatrixType current_type = types[t];
         
         // заполняем матрицу специального типа
-        fill_special_matrix(matrix, size, current_type);
-        
+        double fill_start = omp_get_wtime();
+        fill_special_matrix(&matrix, size, current_type, seed);
+        double fill_time = omp_get_wtime() - fill_start;
+
         printf("=== тип матрицы: %s ===\n", type_names[t]);
         
         // последовательная версия для сравнения (используем static без параллелизма)
         double seq_start = omp_get_wtime();
-        double seq_result = find_max_of_row_minima(matrix, size, current_type, "static");
+        double seq_result = find_max_of_row_minima(&matrix, size, current_type, "static", NULL);
         double seq_time = omp_get_wtime() - seq_start;
         
         printf("последовательная версия: %.2f (время: %.4f сек)\n", seq_result, seq_time);
         
         // тестируем разные типы распределения в параллельной версии
         for (int s = 0; s < 3; s++) {
+            loop_profile_t *profile = loop_profile_begin(schedules[s]);  // NULL без LOOP_PROFILE=1
             double par_start = omp_get_wtime();
-            double par_result = find_max_of_row_minima(matrix, size, current_type, schedules[s]);
+            double par_result = find_max_of_row_minima(&matrix, size, current_type, schedules[s], profile);
             double par_time = omp_get_wtime() - par_start;
             
-            printf("  schedule(%s): %.2f, время: %.4f сек, ускорение: %.2fx\n", 
+            printf("  schedule(%s): %.2f, время: %.4f сек, ускорение: %.2fx\n",
                    schedules[s], par_result, par_time, seq_time / par_time);
+            loop_profile_report(profile);
+        }
+
+        // те же комбинации специализированными ядрами: без strcmp и switch в цикле
+        printf("специализированные ядра (выбор до параллельной области):\n");
+        for (int s = 0; s < 3; s++) {
+            special_kernel_t kernel = special_kernel(current_type, schedules[s], 0);
+            special_kernel_t dispatch = special_kernel(current_type, schedules[s], 1);
+            double generic_time = 1e30, special_time = 1e30, dispatch_time = 1e30, special_result = 0.0;
+            // лучшее из 3 запусков каждой версии - разница в доли миллисекунды
+            for (int rep = 0; rep < 3; rep++) {
+                double start = omp_get_wtime();
+                find_max_of_row_minima(&matrix, size, current_type, schedules[s], NULL);
+                double t = omp_get_wtime() - start;
+                if (t < generic_time) generic_time = t;
+
+                start = omp_get_wtime();
+                special_result = kernel(&matrix, size);
+                t = omp_get_wtime() - start;
+                if (t < special_time) special_time = t;
+
+                start = omp_get_wtime();
+                dispatch(&matrix, size);
+                t = omp_get_wtime() - start;
+                if (t < dispatch_time) dispatch_time = t;
+            }
+            printf("  schedule(%s): %.2f, время: %.4f сек (общее ядро %.4f сек, в %.2f раза быстрее; "
+                   "только выбор ядра %.4f сек, %.2f), разница: %.10f\n", schedules[s], special_result,
+                   special_time, generic_time, generic_time / special_time, dispatch_time,
+                   generic_time / dispatch_time, fabs(special_result - seq_result));
+        }
+
+        // тот же maximin по компактному хранению (плотная матрица хранится как есть)
+        if (current_type != DENSE) {
+            double gen_start = omp_get_wtime();
+            StoredMatrix stored = generate_stored_matrix(size, current_type, seed);
+            double gen_time = omp_get_wtime() - gen_start;
+            if (stored.size == 0) {
+                printf("не удалось выделить память под компактное хранение %d x %d\n", size, size);
+                matrix_free(&matrix);
+                return 1;
+            }
+            double dense_bytes = (double)size * matrix.ld * sizeof(double);
+            double stored_bytes = (double)stored_matrix_bytes(&stored);
+
+            printf("хранение %s: %ld элементов, %.1f МБ против %.1f МБ плотного (в %.1f раз меньше)\n",
+                   storage_name(stored.format), stored.nnz, stored_bytes / 1048576.0,
+                   dense_bytes / 1048576.0, dense_bytes / stored_bytes);
+            printf("  генерация: %.4f сек (плотная: %.4f сек)\n", gen_time, fill_time);
+            for (int s = 0; s < 3; s++) {
+                double par_start = omp_get_wtime();
+                double par_result = find_max_of_row_minima_stored(&stored, schedules[s]);
+                double par_time = omp_get_wtime() - par_start;
+
+                printf("  schedule(%s): %.2f, время: %.4f сек, ускорение: %.2fx, разница с плотной: %.10f\n",
+                       schedules[s], par_result, par_time, seq_time / par_time, fabs(par_result - seq_result));
+            }
+            free_stored_matrix(&stored);
+        }
+
+        // та же матрица без указания типа: структура определяется по выборке строк
+        {
+            double start = omp_get_wtime();
+            MatrixStructure st = detect_structure(&matrix);
+            double detect_time = omp_get_wtime() - start;
+            int fallback = 0;
+            start = omp_get_wtime();
+            StoredMatrix detected = convert_detected(&matrix, &st, &fallback);
+            double convert_time = omp_get_wtime() - start;
+            if (detected.size == 0) {
+                printf("не удалось выделить память под преобразование матрицы %d x %d\n", size, size);
+                matrix_free(&matrix);
+                return 1;
+            }
+
+            // запрос по найденному формату и, для сравнения, единственный безопасный без
+            // знания структуры вариант - полный просмотр с пропуском нулей (лучшее из 3)
+            double query_time = 1e30, untyped_time = 1e30, query_result = 0.0;
+            for (int rep = 0; rep < 3; rep++) {
+                double t0 = omp_get_wtime();
+                query_result = find_max_of_row_minima_stored(&detected, "static");
+                double t = omp_get_wtime() - t0;
+                if (t < query_time) query_time = t;
+
+                t0 = omp_get_wtime();
+                maximin_sparse_static(&matrix, size);
+                t = omp_get_wtime() - t0;
+                if (t < untyped_time) untyped_time = t;
+            }
+
+            printf("автоопределение структуры (выборка %d строк): ", st.sampled_rows);
+            if (st.upper) printf("верхняя треугольная, ");
+            printf("ширина ленты %d, плотность %.3f -> %s%s\n", st.bandwidth, st.density,
+                   storage_name(detected.format), fallback ? " (выборка отвергнута проверкой)" : "");
+            printf("  выборка: %.4f сек, преобразование: %.4f сек, запрос: %.4f сек "
+                   "(полный просмотр без структуры: %.4f сек), разница: %.10f\n",
+                   detect_time, convert_time, query_time, untyped_time, fabs(query_result - seq_result));
+            if (detected.format == STORAGE_DENSE) {
+                printf("  структура не найдена - запросы идут полным просмотром\n");
+            } else if (untyped_time > query_time) {
+                printf("  окупается после %.0f запросов\n",
+                       ceil((detect_time + convert_time) / (untyped_time - query_time)));
+            } else {
+                printf("  формат не быстрее полного просмотра - преобразование не окупается\n");
+            }
+            free_stored_matrix(&detected);
         }
         printf("\n");
     }
 
     // освобождаем память
-    for (int i = 0; i < size; i++) {
-        free(matrix[i]);
-    }
-    free(matrix);
+    matrix_free(&matrix);
 
     return 0;
 }
@@ -4,6 +4,11 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include "../../common/matrix.h"
+#include "../../common/maximin.h"
+#include "../../common/philox_rng.h"
+#include "../../common/work_stealing.h"
+#include "../../common/loop_profile.h"
 
 // функция с неравномерной вычислительной нагрузкой
 // некоторые итерации требуют больше вычислений
@@ -39,11 +44,28 @@ double heavy_computation(int iteration) {
     return result;
 }
 
+// цикл с заданным schedule: omp for с nowait и барьером в loop_probe_finish,
+// чтобы при LOOP_PROFILE=1 видеть работу и ожидание каждого потока;
+// chunk - размер порции из directive для счетчика порций (см. loop_profile.h)
+#define HEAVY_LOOP(directive, chunk)                                          \
+    do {                                                                      \
+        _Pragma("omp parallel reduction(+:total_result)")                     \
+        {                                                                     \
+            loop_probe_t probe = loop_probe_start(profile);                   \
+            LOOP_PROFILE_FOR(&probe, directive,                               \
+                             (int i = 0; i < num_iterations; i++), i, chunk,  \
+                total_result += heavy_computation(i);                         \
+            );                                                                \
+            loop_probe_finish(profile, &probe);                               \
+        }                                                                     \
+    } while (0)
+
 // функция для тестирования разных типов schedule
 void test_schedule(const char* schedule_name, const char* schedule_type, int chunk_size) {
     int num_iterations = 1000;  // общее количество итераций
     double total_result = 0.0;  // переменная для накопления результата
     double start_time, end_time;  // переменные для измерения времени
+    loop_profile_t *profile = loop_profile_begin(schedule_name);  // NULL без LOOP_PROFILE=1
     
     printf("  %s: ", schedule_name);
     fflush(stdout);  // немедленный вывод чтобы видеть прогресс
@@ -54,66 +76,232 @@ void test_schedule(const char* schedule_name, const char* schedule_type, int chu
     if (strcmp(schedule_type, "static") == 0) {
         if (chunk_size > 0) {
             // static с указанным размером блока
-            #pragma omp parallel for schedule(static, chunk_size) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);  // каждая итерация вносит вклад в результат
-            }
+            HEAVY_LOOP("omp for schedule(static, chunk_size) nowait", chunk_size);
         } else {
             // static с автоматическим определением размера блока
-            #pragma omp parallel for schedule(static) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);
-            }
+            HEAVY_LOOP("omp for schedule(static) nowait", LOOP_CHUNK_STATIC);
         }
     }
     else if (strcmp(schedule_type, "dynamic") == 0) {
         if (chunk_size > 0) {
             // dynamic с указанным размером порции
-            #pragma omp parallel for schedule(dynamic, chunk_size) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);
-            }
+            HEAVY_LOOP("omp for schedule(dynamic, chunk_size) nowait", chunk_size);
         } else {
             // dynamic с размером порции по умолчанию
-            #pragma omp parallel for schedule(dynamic) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);
-            }
+            HEAVY_LOOP("omp for schedule(dynamic) nowait", 1);  // порция по умолчанию - 1
         }
     }
     else if (strcmp(schedule_type, "guided") == 0) {
         if (chunk_size > 0) {
             // guided с минимальным размером порции
-            #pragma omp parallel for schedule(guided, chunk_size) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);
-            }
+            HEAVY_LOOP("omp for schedule(guided, chunk_size) nowait", LOOP_CHUNK_UNKNOWN);
         } else {
             // guided с минимальным размером порции по умолчанию
-            #pragma omp parallel for schedule(guided) reduction(+:total_result)
-            for (int i = 0; i < num_iterations; i++) {
-                total_result += heavy_computation(i);
-            }
+            HEAVY_LOOP("omp for schedule(guided) nowait", LOOP_CHUNK_UNKNOWN);
         }
     }
     else if (strcmp(schedule_type, "auto") == 0) {
         // автоматический выбор schedule компилятором
-        #pragma omp parallel for schedule(auto) reduction(+:total_result)
-        for (int i = 0; i < num_iterations; i++) {
-            total_result += heavy_computation(i);
-        }
+        HEAVY_LOOP("omp for schedule(auto) nowait", LOOP_CHUNK_UNKNOWN);
     }
     else if (strcmp(schedule_type, "runtime") == 0) {
         // выбор schedule во время выполнения через переменную окружения
-        #pragma omp parallel for schedule(runtime) reduction(+:total_result)
-        for (int i = 0; i < num_iterations; i++) {
-            total_result += heavy_computation(i);
-        }
+        HEAVY_LOOP("omp for schedule(runtime) nowait", LOOP_CHUNK_UNKNOWN);
     }
     
     end_time = omp_get_wtime();  // засекаем время окончания
     
     printf("время = %.4f сек, результат = %.2f\n", end_time - start_time, total_result);
+    loop_profile_report(profile);  // дисбаланс по потокам (если включен)
+}
+
+// частичная сумма потока в своей кэш-линии (body планировщика не может
+// использовать reduction - он вызывается для кусков цикла, а не для итераций)
+typedef struct {
+    double value;
+    char pad[64 - sizeof(double)];
+} padded_double_t;
+
+static void heavy_body(long begin, long end, void *ctx) {
+    padded_double_t *partial = (padded_double_t *)ctx;
+    double sum = 0.0;
+    for (long i = begin; i < end; i++) {
+        sum += heavy_computation((int)i);
+    }
+    partial[omp_get_thread_num()].value += sum;
+}
+
+// сводка счетчиков кражи работы
+static void print_steal_stats(const ws_stats_t *stats, int threads) {
+    ws_stats_t total = ws_stats_total(stats, threads);
+    printf("      порций: %ld, краж: %ld, неудачных попыток: %ld, итераций по потокам:",
+           total.chunks, total.steals, total.failed_steals);
+    for (int t = 0; t < threads; t++) printf(" %ld", stats[t].iterations);
+    printf("\n");
+}
+
+// тот же цикл через планировщик с кражей работы (common/work_stealing.h);
+// grain - наибольший кусок, который поток выполняет без деления
+void test_work_stealing(const char* name, long grain) {
+    int num_iterations = 1000;
+    int threads = omp_get_max_threads();
+    padded_double_t *partial = (padded_double_t *)aligned_alloc(64, threads * sizeof(padded_double_t));
+    ws_stats_t *stats = (ws_stats_t *)aligned_alloc(64, threads * sizeof(ws_stats_t));
+
+    printf("  %s: ", name);
+    fflush(stdout);
+
+    if (partial == NULL) {
+        // без памяти под частичные суммы - обычный omp for вместо планировщика
+        double total_result = 0.0;
+        double start_time = omp_get_wtime();
+        #pragma omp parallel for schedule(dynamic) reduction(+:total_result)
+        for (int i = 0; i < num_iterations; i++) {
+            total_result += heavy_computation(i);
+        }
+        double end_time = omp_get_wtime();
+        printf("время = %.4f сек, результат = %.2f (omp for: не хватает памяти под частичные суммы)\n",
+               end_time - start_time, total_result);
+        free(stats);
+        return;
+    }
+    memset(partial, 0, threads * sizeof(padded_double_t));
+
+    double start_time = omp_get_wtime();
+    ws_parallel_for(0, num_iterations, grain, heavy_body, partial, stats);
+    double end_time = omp_get_wtime();
+
+    double total_result = 0.0;
+    for (int t = 0; t < threads; t++) total_result += partial[t].value;
+    printf("время = %.4f сек, результат = %.2f\n", end_time - start_time, total_result);
+    if (stats != NULL) print_steal_stats(stats, threads);  // NULL - счетчики не собирались
+
+    free(partial);
+    free(stats);
+}
+
+// матрицы из задания 5: стоимость строки зависит от ее номера
+// - TRIANGULAR: строка i - size - i ненулевых элементов (нагрузка убывает линейно)
+// - BANDED: лента ширины 2 * size / 10 + 1, у краев матрицы короче
+// элементы те же, что в task5 (philox, номер элемента i * size + j)
+typedef enum { MATRIX_TRIANGULAR, MATRIX_BANDED } matrix_kind_t;
+
+typedef struct {
+    const matrix_t *matrix;
+    matrix_kind_t kind;
+    padded_double_t *partial;  // максимум потока
+} matrix_job_t;
+
+static inline void structure_columns(matrix_kind_t kind, long i, long size, long *start, long *end) {
+    if (kind == MATRIX_TRIANGULAR) {
+        *start = i;
+        *end = size;
+    } else {
+        long bandwidth = size / 10;
+        *start = i - bandwidth > 0 ? i - bandwidth : 0;
+        *end = i + bandwidth + 1 < size ? i + bandwidth + 1 : size;
+    }
+}
+
+static void fill_structured(const matrix_t *m, matrix_kind_t kind, uint64_t seed) {
+    long size = m->rows;
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < size; i++) {
+        long start, end;
+        structure_columns(kind, i, size, &start, &end);
+        double *row = matrix_row(m, i);
+        rng_fill_range(row + start, end - start, seed, 0, (uint64_t)i * size + start, 0.0, 100.0);
+    }
+}
+
+// минимум строки в пределах структуры (нули вне ее не просматриваются)
+static inline double structured_row_min(const matrix_t *m, matrix_kind_t kind, long i) {
+    long start, end;
+    structure_columns(kind, i, m->rows, &start, &end);
+    return maximin_block_min(matrix_row(m, i) + start, end - start, 1e9);
+}
+
+static void matrix_body(long begin, long end, void *ctx) {
+    matrix_job_t *job = (matrix_job_t *)ctx;
+    double best = -1e9;
+    for (long i = begin; i < end; i++) {
+        double v = structured_row_min(job->matrix, job->kind, i);
+        best = v > best ? v : best;
+    }
+    padded_double_t *mine = &job->partial[omp_get_thread_num()];
+    if (best > mine->value) mine->value = best;
+}
+
+// один проход с заданным schedule openmp (как в test_schedule)
+#define MATRIX_SCHEDULE_LOOP(directive)                                       \
+    do {                                                                      \
+        _Pragma(directive)                                                    \
+        for (long i = 0; i < size; i++) {                                     \
+            double v = structured_row_min(m, kind, i);                        \
+            result = v > result ? v : result;                                 \
+        }                                                                     \
+    } while (0)
+
+void test_matrix_schedules(const char *name, matrix_kind_t kind, long size, uint64_t seed) {
+    matrix_t matrix = matrix_alloc(size, size);
+    if (matrix.data == NULL) {
+        printf("  %s: не хватает памяти для %ldx%ld\n", name, size, size);
+        return;
+    }
+    const matrix_t *m = &matrix;
+    fill_structured(m, kind, seed);
+
+    const char *names[] = {"static", "dynamic", "guided", "auto"};
+    printf("  %s %ldx%ld:\n", name, size, size);
+    double reference = 0.0;
+    for (int s = 0; s < 4; s++) {
+        double result = -1e9;
+        double start_time = omp_get_wtime();
+        switch (s) {
+            case 0: MATRIX_SCHEDULE_LOOP("omp parallel for schedule(static) reduction(max:result)"); break;
+            case 1: MATRIX_SCHEDULE_LOOP("omp parallel for schedule(dynamic) reduction(max:result)"); break;
+            case 2: MATRIX_SCHEDULE_LOOP("omp parallel for schedule(guided) reduction(max:result)"); break;
+            case 3: MATRIX_SCHEDULE_LOOP("omp parallel for schedule(auto) reduction(max:result)"); break;
+        }
+        double end_time = omp_get_wtime();
+        if (s == 0) reference = result;
+        printf("    %-14s время = %.4f сек, результат = %.6f\n", names[s], end_time - start_time, result);
+    }
+
+    int threads = omp_get_max_threads();
+    padded_double_t *partial = (padded_double_t *)aligned_alloc(64, threads * sizeof(padded_double_t));
+    ws_stats_t *stats = (ws_stats_t *)aligned_alloc(64, threads * sizeof(ws_stats_t));
+    long grains[] = {1, 16};
+    for (int g = 0; g < 2; g++) {
+        if (partial == NULL) {
+            // без памяти под максимумы потоков - обычный omp for порциями того же размера
+            long grain = grains[g];
+            double result = -1e9;
+            double start_time = omp_get_wtime();
+            MATRIX_SCHEDULE_LOOP("omp parallel for schedule(dynamic, grain) reduction(max:result)");
+            double end_time = omp_get_wtime();
+            char label[32];
+            snprintf(label, sizeof(label), "dynamic, %ld", grain);
+            printf("    %-14s время = %.4f сек, результат = %.6f (вместо stealing: не хватает памяти)\n",
+                   label, end_time - start_time, result);
+            continue;
+        }
+        for (int t = 0; t < threads; t++) partial[t].value = -1e9;
+        matrix_job_t job = {m, kind, partial};
+        double start_time = omp_get_wtime();
+        ws_parallel_for(0, size, grains[g], matrix_body, &job, stats);
+        double end_time = omp_get_wtime();
+        double result = -1e9;
+        for (int t = 0; t < threads; t++) result = partial[t].value > result ? partial[t].value : result;
+        char label[32];
+        snprintf(label, sizeof(label), "stealing, g=%ld", grains[g]);
+        printf("    %-14s время = %.4f сек, результат = %.6f%s\n", label,
+               end_time - start_time, result, result == reference ? "" : " (не совпадает!)");
+        if (stats != NULL) print_steal_stats(stats, threads);
+    }
+    free(partial);
+    free(stats);
+    matrix_free(&matrix);
 }
 
 // функция для анализа распределения нагрузки по итерациям
@@ -160,6 +348,14 @@ int main(int argc, char *argv[]) {
     if (argc > 1) {
         num_threads = atoi(argv[1]);  // можно передать количество потоков как аргумент
     }
+    long matrix_size = 4000;  // размер матриц для сравнения на строках разной длины
+    if (argc > 2) {
+        matrix_size = atol(argv[2]);
+    }
+    if (num_threads < 1 || matrix_size < 1) {
+        printf("использование: %s [потоков] [размер матрицы]\n", argv[0]);
+        return 1;
+    }
     
     omp_set_num_threads(num_threads);  // устанавливаем количество потоков для openmp
     
@@ -208,6 +404,17 @@ int main(int argc, char *argv[]) {
     printf("\nдругие schedule типы:\n");
     test_schedule("auto", "auto", 0);
     test_schedule("runtime", "runtime", 0);
+
+    // планировщик с кражей работы: очереди chase-lev у каждого потока вместо общего счетчика
+    printf("\nкража работы (common/work_stealing.h):\n");
+    test_work_stealing("stealing, grain=1", 1);
+    test_work_stealing("stealing, grain=10", 10);
+    test_work_stealing("stealing, grain=50", 50);
+
+    // строки разной длины: треугольная и ленточная матрицы из задания 5
+    printf("\nмаксимум минимумов строк специальных матриц:\n");
+    test_matrix_schedules("TRIANGULAR", MATRIX_TRIANGULAR, matrix_size, rng_seed_from_env());
+    test_matrix_schedules("BANDED", MATRIX_BANDED, matrix_size, rng_seed_from_env());
     
     printf("\nвывод: лучший результат выделен\n");
     
@@ -4,12 +4,14 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include "../../common/philox_rng.h"
+#include "../../common/numa_alloc.h"
+#include "../../common/bench_harness.h"
+#include "../../common/loop_profile.h"
 
-// инициализация массива случайными числами
-void initialize_array(double *arr, int size) {
-    for (int i = 0; i < size; i++) {
-        arr[i] = (double)rand() / RAND_MAX * 100.0;  // случайные числа от 0 до 100
-    }
+// инициализация массива случайными числами (параллельный генератор philox)
+void initialize_array(double *arr, int size, uint64_t seed) {
+    rng_fill_uniform(arr, size, seed, 0, 0.0, 100.0);  // случайные числа от 0 до 100
 }
 
 // 1. редукция с помощью reduction (самый эффективный способ)
@@ -111,24 +113,80 @@ double reduction_atomic_bad(double *arr, int size) {
     return sum;
 }
 
+// редукция с замером каждого потока: пропускная способность по узлам numa
+void reduction_socket_bandwidth(double *arr, int size) {
+    double sum = 0.0;
+    int used_threads = 1;
+    numa_thread_bw_t *thread_bw = (numa_thread_bw_t*)calloc(omp_get_max_threads(), sizeof(numa_thread_bw_t));
+
+    #pragma omp parallel reduction(+:sum)
+    {
+        double thread_start = omp_get_wtime();
+        #pragma omp for schedule(static) nowait  // то же распределение, что при первом касании
+        for (int i = 0; i < size; i++) {
+            sum += arr[i];
+        }
+        double thread_time = omp_get_wtime() - thread_start;
+        long begin, end;
+        numa_static_range(size, &begin, &end);  // итерации потока по schedule(static)
+        if (thread_bw != NULL) {
+            numa_record(&thread_bw[omp_get_thread_num()], (double)(end - begin) * sizeof(double), thread_time);
+        }
+        #pragma omp single nowait
+        used_threads = omp_get_num_threads();
+    }
+
+    numa_print_socket_bandwidth(thread_bw, used_threads);
+    free(thread_bw);
+}
+
+// тот же цикл, что в reduction_reduction, с профилем дисбаланса по потокам
+// (один запуск после замеров, только при LOOP_PROFILE=1)
+void reduction_profile(double *arr, int size) {
+    double sum = 0.0;
+    loop_profile_t *profile = loop_profile_begin("reduction");
+
+    #pragma omp parallel reduction(+:sum)
+    {
+        loop_probe_t probe = loop_probe_start(profile);
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait", (int i = 0; i < size; i++), i,
+                         LOOP_CHUNK_STATIC,
+            sum += arr[i];
+        );
+        loop_probe_finish(profile, &probe);
+    }
+
+    loop_profile_report(profile);
+}
+
+// параметры замера одного метода (передаются в bench_run)
+typedef struct {
+    double (*func)(double*, int);
+    double *array;
+    int size;
+    double result;  // результат последнего запуска
+} method_ctx_t;
+
+void run_method(void *arg) {
+    method_ctx_t *ctx = (method_ctx_t*)arg;
+    ctx->result = ctx->func(ctx->array, ctx->size);
+}
+
 // функция для измерения времени одного метода
+// прогрев выполняется на полном массиве, время - медиана по cfg.reps повторениям
 double measure_time(const char* method_name, double (*func)(double*, int), 
-                   double *array, int size, double reference_result, int verbose) {
-    double start_time, end_time, result;
-    
-    // "прогрев" кэша - выполняем метод на маленьком массиве чтобы прогреть кэш
-    func(array, 1000);
+                   double *array, int size, double reference_result, int verbose,
+                   bench_config_t cfg) {
+    method_ctx_t ctx = {func, array, size, 0.0};
+    bench_result_t stats;
+    bench_run(method_name, run_method, &ctx, cfg, &stats);
     
-    start_time = omp_get_wtime();  // засекаем время начала
-    result = func(array, size);  // выполняем метод на полном массиве
-    end_time = omp_get_wtime();  // засекаем время окончания
-    
-    double error = fabs(result - reference_result);  // вычисляем ошибку относительно эталона
-    double time_taken = end_time - start_time;  // вычисляем время выполнения
+    double error = fabs(ctx.result - reference_result);  // вычисляем ошибку относительно эталона
+    double time_taken = stats.median;  // медиана устойчива к выбросам
     
     if (verbose) {
-        printf("  %-25s: время = %.6f сек, ошибка = %.10f", 
-               method_name, time_taken, error);
+        printf("  %-25s: время = %.6f сек (p95 %.6f, ±%.6f), ошибка = %.10f", 
+               method_name, time_taken, stats.p95, (stats.ci_high - stats.ci_low) / 2.0, error);
         
         if (error > 1e-6) {  // если ошибка значительная - выводим предупреждение
             printf("ошибкаа!");
@@ -136,6 +194,11 @@ double measure_time(const char* method_name, double (*func)(double*, int),
         printf("\n");
     }
     
+    // строка результата пишется только если задан BENCH_OUTPUT
+    char params[64];
+    snprintf(params, sizeof(params), "size=%d", size);
+    bench_write(NULL, &stats, params, bench_threads(), 1);
+    
     return time_taken;
 }
 
@@ -162,17 +225,24 @@ int main(int argc, char *argv[]) {
     
     omp_set_num_threads(num_threads);  // устанавливаем количество потоков для openmp
     
+    // прогрев и повторения: BENCH_WARMUP / BENCH_REPS (по умолчанию 1 и 5)
+    bench_config_t cfg = bench_config_from_env(1, 5);
+    
     // выделение памяти и инициализация массива
-    double *array = (double*)malloc(size * sizeof(double));
-    srand(time(NULL));  // инициализация генератора случайных чисел
-    initialize_array(array, size);  // заполнение массива случайными числами
+    // параллельное первое касание по schedule(static) размещает страницы на узлах numa потоков
+    double *array = (double*)numa_alloc_first_touch(size, sizeof(double));
+    uint64_t seed = rng_seed_from_env();  // фиксированный seed или RNG_SEED
+    initialize_array(array, size, seed);  // заполнение массива случайными числами
     
     if (verbose) {
         printf("сравнение способов редукции\n");
         printf("============================\n");
         printf("размер массива: %d\n", size);
         printf("количество потоков: %d\n", num_threads);
-        printf("тип операции: суммирование\n\n");
+        printf("тип операции: суммирование\n");
+        printf("повторений: %d (прогрев %d)\n", cfg.reps, cfg.warmup);
+        numa_print_binding();  // OMP_PLACES / OMP_PROC_BIND и размещение потоков по узлам
+        printf("\n");
     }
     
     // вычисляем эталонное значение (последовательно для проверки корректности)
@@ -206,7 +276,7 @@ int main(int argc, char *argv[]) {
     // тестируем все методы
     for (int i = 0; i < num_methods; i++) {
         times[i] = measure_time(methods[i].name, methods[i].function, 
-                               array, size, reference_sum, verbose);
+                               array, size, reference_sum, verbose, cfg);
     }
     
     // вывод в csv формате для последующего анализа
@@ -233,6 +303,14 @@ int main(int argc, char *argv[]) {
             printf("  %-15s: %.2fx %s\n", methods[i].name, ratio,
                    ratio >= 1.0 ? "+" : "-");  // показываем успешность метода
         }
+        
+        printf("\nreduction по узлам numa:\n");
+        reduction_socket_bandwidth(array, size);
+
+        if (loop_profile_enabled()) {
+            printf("\nreduction по потокам:\n");
+            reduction_profile(array, size);
+        }
     }
     
     free(array);  // освобождаем память
@@ -2,27 +2,31 @@
 #include <stdlib.h>
 #include <omp.h>
 #include <time.h>
+#include "../../common/philox_rng.h"
+#include "../../common/matrix.h"
+#include "../../common/maximin.h"
+#include "../../common/loop_profile.h"
 
 #define MATRIX_SIZE 2000
 
-// заполнение матрицы случайными числами
-void fill_matrix(double **matrix, int size) {
+// заполнение матрицы случайными числами (philox, строки параллельно)
+void fill_matrix(const matrix_t *matrix, int size, uint64_t seed) {
+    #pragma omp parallel for schedule(static)
     for (int i = 0; i < size; i++) {
-        for (int j = 0; j < size; j++) {
-            matrix[i][j] = (double)rand() / RAND_MAX * 100.0;
-        }
+        rng_fill_range(matrix_row(matrix, i), size, seed, 0, (uint64_t)i * size, 0.0, 100.0);
     }
 }
 
 // 1. последовательная версия (базовая)
-double sequential_version(double **matrix, int size) {
+double sequential_version(const matrix_t *matrix, int size) {
     double max_of_min = -1.0;
     
     for (int i = 0; i < size; i++) {
-        double row_min = matrix[i][0];
+        const double *row = matrix_row(matrix, i);
+        double row_min = row[0];
         for (int j = 1; j < size; j++) {
-            if (matrix[i][j] < row_min) {
-                row_min = matrix[i][j];
+            if (row[j] < row_min) {
+                row_min = row[j];
             }
         }
         if (row_min > max_of_min) {
@@ -34,25 +38,29 @@ double sequential_version(double **matrix, int size) {
 }
 
 // 2. только внешний параллелизм
-double outer_parallel_only(double **matrix, int size) {
+// profile - профиль дисбаланса по потокам (loop_profile_begin) или NULL
+double outer_parallel_only(const matrix_t *matrix, int size, loop_profile_t *profile) {
     double max_of_min = -1.0;
     
     #pragma omp parallel
     {
         double local_max = -1.0;
         
-        #pragma omp for
-        for (int i = 0; i < size; i++) {
-            double row_min = matrix[i][0];
+        loop_probe_t probe = loop_probe_start(profile);
+        LOOP_PROFILE_FOR(&probe, "omp for schedule(static) nowait", (int i = 0; i < size; i++), i,
+                         LOOP_CHUNK_STATIC,
+            const double *row = matrix_row(matrix, i);
+            double row_min = row[0];
             for (int j = 1; j < size; j++) {
-                if (matrix[i][j] < row_min) {
-                    row_min = matrix[i][j];
+                if (row[j] < row_min) {
+                    row_min = row[j];
                 }
             }
             if (row_min > local_max) {
                 local_max = row_min;
             }
-        }
+        );
+        loop_probe_finish(profile, &probe);  // барьер вместо неявного у omp for
         
         #pragma omp critical
         {
@@ -66,7 +74,7 @@ double outer_parallel_only(double **matrix, int size) {
 }
 
 // 3. вложенный параллелизм (оба цикла параллельны)
-double nested_parallel_both(double **matrix, int size) {
+double nested_parallel_both(const matrix_t *matrix, int size) {
     double max_of_min = -1.0;
     
     #pragma omp parallel
@@ -75,13 +83,14 @@ double nested_parallel_both(double **matrix, int size) {
         
         #pragma omp for
         for (int i = 0; i < size; i++) {
-            double row_min = matrix[i][0];
+            const double *row = matrix_row(matrix, i);
+            double row_min = row[0];
             
             // вложенный параллелизм - внутренний цикл
             #pragma omp parallel for reduction(min:row_min)
             for (int j = 0; j < size; j++) {
-                if (matrix[i][j] < row_min) {
-                    row_min = matrix[i][j];
+                if (row[j] < row_min) {
+                    row_min = row[j];
                 }
             }
             
@@ -102,7 +111,7 @@ double nested_parallel_both(double **matrix, int size) {
 }
 
 // 4. вложенный параллелизм с ограничением потоков
-double nested_parallel_controlled(double **matrix, int size) {
+double nested_parallel_controlled(const matrix_t *matrix, int size) {
     double max_of_min = -1.0;
     
     #pragma omp parallel
@@ -111,13 +120,14 @@ double nested_parallel_controlled(double **matrix, int size) {
         
         #pragma omp for
         for (int i = 0; i < size; i++) {
-            double row_min = matrix[i][0];
+            const double *row = matrix_row(matrix, i);
+            double row_min = row[0];
             
             // вложенный параллелизм с ограничением потоков
             #pragma omp parallel for reduction(min:row_min) num_threads(2)
             for (int j = 0; j < size; j++) {
-                if (matrix[i][j] < row_min) {
-                    row_min = matrix[i][j];
+                if (row[j] < row_min) {
+                    row_min = row[j];
                 }
             }
             
@@ -139,18 +149,17 @@ double nested_parallel_controlled(double **matrix, int size) {
 
 int main() {
     int size = MATRIX_SIZE;
-    double **matrix;
     double start_time, end_time;
     
     // выделение памяти под матрицу
-    matrix = (double**)malloc(size * sizeof(double*));
-    for (int i = 0; i < size; i++) {
-        matrix[i] = (double*)malloc(size * sizeof(double));
+    matrix_t matrix = matrix_alloc(size, size);
+    if (matrix.data == NULL) {
+        printf("не удалось выделить память под матрицу %d x %d\n", size, size);
+        return 1;
     }
     
     // заполнение матрицы случайными числами
-    srand(time(NULL));
-    fill_matrix(matrix, size);
+    fill_matrix(&matrix, size, rng_seed_from_env());
     
     printf("сравнение стратегий параллелизма для задачи 4\n");
     printf("=============================================\n");
@@ -167,7 +176,7 @@ int main() {
     // тест 1: последовательная версия
     printf("1. последовательная версия:\n");
     start_time = omp_get_wtime();
-    result = sequential_version(matrix, size);
+    result = sequential_version(&matrix, size);
     end_time = omp_get_wtime();
     printf("   результат: %.2f\n", result);
     printf("   время: %.4f сек\n\n", end_time - start_time);
@@ -175,17 +184,20 @@ int main() {
     
     // тест 2: только внешний параллелизм
     printf("2. только внешний параллелизм:\n");
+    loop_profile_t *profile = loop_profile_begin("внешний цикл");  // NULL без LOOP_PROFILE=1
     start_time = omp_get_wtime();
-    result = outer_parallel_only(matrix, size);
+    result = outer_parallel_only(&matrix, size, profile);
     end_time = omp_get_wtime();
     printf("   результат: %.2f\n", result);
     printf("   время: %.4f сек\n", end_time - start_time);
-    printf("   ускорение: %.2fx\n\n", seq_time / (end_time - start_time));
+    printf("   ускорение: %.2fx\n", seq_time / (end_time - start_time));
+    loop_profile_report(profile);
+    printf("\n");
     
     // тест 3: вложенный параллелизм (оба цикла)
     printf("3. вложенный параллелизм (оба цикла):\n");
     start_time = omp_get_wtime();
-    result = nested_parallel_both(matrix, size);
+    result = nested_parallel_both(&matrix, size);
     end_time = omp_get_wtime();
     printf("   результат: %.2f\n", result);
     printf("   время: %.4f сек\n", end_time - start_time);
@@ -194,17 +206,27 @@ int main() {
     // тест 4: вложенный параллелизм с контролем
     printf("4. вложенный параллелизм (контролируемый):\n");
     start_time = omp_get_wtime();
-    result = nested_parallel_controlled(matrix, size);
+    result = nested_parallel_controlled(&matrix, size);
+    end_time = omp_get_wtime();
+    printf("   результат: %.2f\n", result);
+    printf("   время: %.4f сек\n", end_time - start_time);
+    printf("   ускорение: %.2fx\n\n", seq_time / (end_time - start_time));
+    
+    // тест 5: плитки и задачи вместо вложенных параллельных областей
+    // (../../common/maximin.h: одна область, taskloop по плиткам, без critical на строку)
+    printf("5. плитки (taskloop по блокам строк и столбцов):\n");
+    maximin_tiles_t tiles = maximin_tiles_choose(size, size, omp_get_max_threads());
+    start_time = omp_get_wtime();
+    result = maximin_tiled(&matrix, &tiles);
     end_time = omp_get_wtime();
+    printf("   плитка: %ld x %ld, плиток: %ld x %ld\n",
+           tiles.tile_rows, tiles.tile_cols, tiles.row_blocks, tiles.col_blocks);
     printf("   результат: %.2f\n", result);
     printf("   время: %.4f сек\n", end_time - start_time);
     printf("   ускорение: %.2fx\n\n", seq_time / (end_time - start_time));
     
     // освобождение памяти
-    for (int i = 0; i < size; i++) {
-        free(matrix[i]);
-    }
-    free(matrix);
+    matrix_free(&matrix);
     
     return 0;
 }